@@ -31,6 +31,7 @@ BuildRoot:		/var/tmp/%{name}-%{version}
 
 BuildRequires:	gcc-c++ >= 5
 BuildRequires:	pkgconfig(libcurl)
+BuildRequires:	pkgconfig(libcrypto)
 BuildRequires:	pkgconfig(libudjat) >= 2.0.0
 
 BuildRequires:	meson >= 0.61.4
@@ -93,6 +94,8 @@ C++ HTTP client classes for use with lib%{product_name}
 
 %dir %{_includedir}/udjat/tools/url/handler
 %{_includedir}/udjat/tools/url/handler/*.h
+%{_includedir}/udjat/tools/http/sink.h
+%{_includedir}/udjat/tools/http/metrics.h
 
 %post -n %{udjat_library} -p /sbin/ldconfig
 
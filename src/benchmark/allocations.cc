@@ -0,0 +1,50 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Replace operator new to count the allocations of each thread.
+  */
+
+ #include "allocations.h"
+ #include <cstdlib>
+ #include <new>
+
+ namespace Benchmark {
+
+	thread_local Allocations allocations;
+
+ }
+
+ void * operator new(size_t size) {
+	Benchmark::allocations.count++;
+	Benchmark::allocations.bytes += size;
+	void *ptr = malloc(size ? size : 1);
+	if(!ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+ }
+
+ void operator delete(void *ptr) noexcept {
+	free(ptr);
+ }
+
+ void operator delete(void *ptr, size_t) noexcept {
+	free(ptr);
+ }
@@ -0,0 +1,38 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Declare the heap allocation counters used by the benchmarks.
+  */
+
+ #pragma once
+ #include <cstdint>
+
+ namespace Benchmark {
+
+	/// @brief Heap allocations, counted by the replaced operator new.
+	struct Allocations {
+		uint64_t count = 0;
+		uint64_t bytes = 0;
+	};
+
+	/// @brief Allocations of the current thread.
+	extern thread_local Allocations allocations;
+
+ }
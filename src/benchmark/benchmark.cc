@@ -0,0 +1,582 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Loopback benchmarks for the HTTP client.
+  *
+  * Runs each client entry point against an in-process HTTP/1.1 server across
+  * payload sizes, concurrency levels and keep-alive on/off, writing one JSON
+  * object per scenario on stdout (requests/second, latency percentiles in
+  * microseconds and heap allocations per request).
+  *
+  * Options:
+  *
+  *  --quick          Small matrix, for CI runs.
+  *  --requests=N     Requests per scenario (split between the client threads).
+  *  --filter=NAME    Run only the scenarios with NAME on the benchmark name.
+  *  --agents=N       Number of agents on the agent-refresh scenario.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <udjat/tools/url.h>
+ #include <udjat/tools/url/handler.h>
+ #include <udjat/tools/url/handler/http.h>
+ #include <udjat/tools/value.h>
+ #include <udjat/tools/xml.h>
+ #include <udjat/agent/http.h>
+ #include <private/spool.h>
+ #include "server.h"
+ #include "allocations.h"
+ #include <atomic>
+ #include <chrono>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <functional>
+ #include <iostream>
+ #include <memory>
+ #include <thread>
+ #include <vector>
+ #include <algorithm>
+ #include <unistd.h>
+ #include <dirent.h>
+ #include <errno.h>
+
+ using namespace Udjat;
+ using namespace std;
+
+ namespace Benchmark {
+
+	static struct {
+		bool quick = false;
+		size_t requests = 1000;
+		size_t agents = 10000;
+		const char *filter = nullptr;
+	} options;
+
+	/// @brief A request on a client thread, return true on success.
+	using Call = std::function<bool()>;
+
+	/// @brief Build the per-thread request (handler creation is not measured).
+	using Setup = std::function<Call(const string &url)>;
+
+	struct Result {
+		const char *name;
+		size_t payload;
+		size_t concurrency;
+		bool keepalive;
+		uint64_t requests = 0;
+		uint64_t errors = 0;
+		double seconds = 0;
+		vector<uint32_t> latency;		///< @brief Request latencies in microseconds.
+		uint64_t allocations = 0;
+		uint64_t bytes = 0;
+		bool counted = true;			///< @brief Allocations are from the measured threads.
+	};
+
+	static void report(Result &result) {
+
+		sort(result.latency.begin(),result.latency.end());
+
+		auto percentile = [&result](unsigned int p) -> unsigned int {
+			if(result.latency.empty()) {
+				return 0;
+			}
+			return result.latency[min(result.latency.size()-1,(result.latency.size() * p) / 100)];
+		};
+
+		double requests = (double) (result.requests ? result.requests : 1);
+
+		printf(
+			"{\"benchmark\":\"%s\",\"payload\":%zu,\"concurrency\":%zu,\"keep-alive\":%s,"
+			"\"requests\":%llu,\"errors\":%llu,\"seconds\":%.6f,\"rps\":%.1f,"
+			"\"latency-us\":{\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u}",
+			result.name,
+			result.payload,
+			result.concurrency,
+			(result.keepalive ? "true" : "false"),
+			(unsigned long long) result.requests,
+			(unsigned long long) result.errors,
+			result.seconds,
+			(result.seconds > 0 ? result.requests / result.seconds : 0.0),
+			percentile(50),
+			percentile(90),
+			percentile(99),
+			(result.latency.empty() ? 0 : result.latency.back())
+		);
+
+		if(result.counted) {
+			printf(
+				",\"allocations\":{\"per-request\":%.2f,\"bytes-per-request\":%.1f}",
+				result.allocations / requests,
+				result.bytes / requests
+			);
+		}
+
+		printf("}\n");
+		fflush(stdout);
+
+	}
+
+	static bool selected(const char *name) noexcept {
+		return !options.filter || strstr(name,options.filter);
+	}
+
+	/// @brief Run 'requests' calls from 'concurrency' threads.
+	static void run(const char *name, const char *path, size_t payload, size_t concurrency, bool keepalive, Server &server, const Setup &setup) {
+
+		Result result;
+		result.name = name;
+		result.payload = payload;
+		result.concurrency = concurrency;
+		result.keepalive = keepalive;
+
+		char buffer[64];
+		snprintf(buffer,sizeof(buffer),"%s%zu",path,payload);
+		const string url = server.url(buffer);
+
+		size_t count = max(options.requests / concurrency,(size_t) 1);
+
+		vector<vector<uint32_t>> latencies(concurrency);
+		for(auto &latency : latencies) {
+			latency.reserve(count);
+		}
+
+		atomic<size_t> ready{0};
+		atomic<bool> start{false};
+		atomic<uint64_t> errors{0};
+		atomic<uint64_t> allocs{0};
+		atomic<uint64_t> bytes{0};
+
+		vector<thread> clients;
+		for(size_t ix = 0; ix < concurrency; ix++) {
+
+			clients.emplace_back([&,ix](){
+
+				Call call;
+				try {
+					call = setup(url);
+					call();		// Warm up, opens the connection.
+				} catch(const exception &e) {
+					cerr << name << ": " << e.what() << endl;
+				}
+
+				ready++;
+				while(!start) {
+					this_thread::yield();
+				}
+
+				auto &latency = latencies[ix];
+				uint64_t failed = 0;
+				auto count0 = allocations.count;
+				auto bytes0 = allocations.bytes;
+
+				for(size_t request = 0; request < count; request++) {
+
+					auto begin = chrono::steady_clock::now();
+					bool ok = false;
+					try {
+						ok = call && call();
+					} catch(...) {
+						ok = false;
+					}
+					auto end = chrono::steady_clock::now();
+
+					latency.push_back((uint32_t) chrono::duration_cast<chrono::microseconds>(end-begin).count());
+					if(!ok) {
+						failed++;
+					}
+
+				}
+
+				allocs += (allocations.count - count0);
+				bytes += (allocations.bytes - bytes0);
+				errors += failed;
+
+			});
+
+		}
+
+		while(ready < concurrency) {
+			this_thread::yield();
+		}
+
+		auto begin = chrono::steady_clock::now();
+		start = true;
+
+		for(auto &client : clients) {
+			client.join();
+		}
+
+		result.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		result.requests = count * concurrency;
+		result.errors = errors;
+		result.allocations = allocs;
+		result.bytes = bytes;
+
+		for(auto &latency : latencies) {
+			result.latency.insert(result.latency.end(),latency.begin(),latency.end());
+		}
+
+		report(result);
+
+	}
+
+	/// @brief Refresh sweeps over 'count' agents, the first one builds the handlers.
+	static void agents(size_t count, Server &server) {
+
+		const string url = server.url("/blob/0");
+
+		pugi::xml_document document;
+		auto root = document.append_child("agents");
+		for(size_t ix = 0; ix < count; ix++) {
+			auto node = root.append_child("agent");
+			node.append_attribute("name") = ("agent" + std::to_string(ix)).c_str();
+			node.append_attribute("type") = "url";
+			node.append_attribute("url") = url.c_str();
+		}
+
+		vector<shared_ptr<HTTP::Agent>> agents;
+		agents.reserve(count);
+		for(auto node = root.child("agent"); node; node = node.next_sibling("agent")) {
+			agents.push_back(make_shared<HTTP::Agent>(node));
+		}
+
+		for(const char *name : { "agent-refresh-first", "agent-refresh" }) {
+
+			Result result;
+			result.name = name;
+			result.concurrency = 1;
+			result.payload = 0;
+			result.keepalive = false;
+			result.latency.reserve(count);
+
+			auto served = server.requests();
+			auto count0 = allocations.count;
+			auto bytes0 = allocations.bytes;
+			auto begin = chrono::steady_clock::now();
+
+			for(auto &agent : agents) {
+				auto start = chrono::steady_clock::now();
+				agent->refresh(false);
+				result.latency.push_back((uint32_t) chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now()-start).count());
+			}
+
+			result.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+			result.requests = count;
+			result.errors = count - min((uint64_t) count,server.requests() - served);
+			result.allocations = allocations.count - count0;
+			result.bytes = allocations.bytes - bytes0;
+
+			report(result);
+
+		}
+
+	}
+
+	/// @brief Remove a spool directory.
+	static void remove(const char *path) {
+		DIR *dir = opendir(path);
+		if(dir) {
+			struct dirent *entry;
+			while((entry = readdir(dir)) != nullptr) {
+				if(entry->d_name[0] != '.') {
+					unlinkat(dirfd(dir),entry->d_name,0);
+				}
+			}
+			closedir(dir);
+		}
+		rmdir(path);
+	}
+
+	/// @brief Replay throughput of requests left on the spool by a previous run.
+	static void replay(size_t payload, bool keepalive, Server &server) {
+
+		Result result;
+		result.name = "spool-replay";
+		result.payload = payload;
+		result.concurrency = 1;
+		result.keepalive = keepalive;
+		result.counted = false;		// The replay runs on the spool worker thread.
+
+		char path[] = "/tmp/udjat-benchmark-XXXXXX";
+		if(!mkdtemp(path)) {
+			perror(path);
+			return;
+		}
+
+		HTTP::Spool::Limits limits;
+		limits.size = 1ULL << 30;
+
+		const string body(payload,'x');
+		size_t count = options.requests;
+
+		{
+			// Server unavailable, everything goes to disk.
+			HTTP::Spool spool{path,limits,[](const string &){
+				return false;
+			}};
+			for(size_t ix = 0; ix < count; ix++) {
+				spool.push(body);
+			}
+		}
+
+		HTTP::Handler handler{URL{server.url("/post").c_str()}};
+		result.latency.reserve(count);
+		atomic<uint64_t> delivered{0};
+		atomic<uint64_t> failed{0};
+
+		auto begin = chrono::steady_clock::now();
+
+		{
+			HTTP::Spool spool{path,limits,[&](const string &payload){
+				auto begin = chrono::steady_clock::now();
+				int rc = handler.test(HTTP::Post,payload.c_str());
+				result.latency.push_back((uint32_t) chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now()-begin).count());
+				if(rc < 200 || rc > 299) {
+					failed++;
+					return false;
+				}
+				delivered++;
+				return true;
+			}};
+
+			while(delivered < count && !failed) {
+				this_thread::sleep_for(chrono::microseconds(100));
+			}
+
+		}
+
+		result.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		result.requests = delivered;
+		result.errors = failed;
+
+		report(result);
+		remove(path);
+
+	}
+
+ }
+
+ using namespace Benchmark;
+
+ int main(int argc, char **argv) {
+
+	for(int arg = 1; arg < argc; arg++) {
+		if(!strcmp(argv[arg],"--quick")) {
+			options.quick = true;
+			options.requests = 200;
+			options.agents = 1000;
+		} else if(!strncmp(argv[arg],"--requests=",11)) {
+			options.requests = max(strtoul(argv[arg]+11,nullptr,10),1UL);
+		} else if(!strncmp(argv[arg],"--agents=",9)) {
+			options.agents = max(strtoul(argv[arg]+9,nullptr,10),1UL);
+		} else if(!strncmp(argv[arg],"--filter=",9)) {
+			options.filter = argv[arg]+9;
+		} else {
+			cerr << "Usage: " << argv[0] << " [--quick] [--requests=N] [--agents=N] [--filter=NAME]" << endl;
+			return 2;
+		}
+	}
+
+	// Required by URL::tempfile.
+	HTTP::Handler::Factory factory{"http"};
+
+	vector<size_t> payloads{256, 4096, 65536, 1048576};
+	vector<size_t> concurrencies{1, 4, 16};
+	if(options.quick) {
+		payloads = {4096, 65536};
+		concurrencies = {1, 4};
+	}
+
+	static const struct {
+		const char *name;
+		const char *path;
+		Setup setup;
+	} benchmarks[] = {
+		{
+			"test",
+			"/blob/",
+			[](const string &url) -> Call {
+				auto handler = make_shared<HTTP::Handler>(URL{url.c_str()});
+				return [handler](){
+					int rc = handler->test();
+					return rc >= 200 && rc <= 299;
+				};
+			}
+		},
+		{
+			"perform",
+			"/blob/",
+			[](const string &url) -> Call {
+				auto handler = make_shared<HTTP::Handler>(URL{url.c_str()});
+				auto writer = make_shared<std::function<bool(uint64_t, uint64_t, const void *, size_t)>>(
+					[](uint64_t, uint64_t, const void *, size_t){
+						return false;
+					}
+				);
+				return [handler,writer](){
+					int rc = handler->perform(HTTP::Get,"",*writer);
+					return rc >= 200 && rc <= 299;
+				};
+			}
+		},
+		{
+			"perform-sink",
+			"/blob/",
+			[](const string &url) -> Call {
+				// Same transfer as 'perform', written into a preallocated region instead of a writer.
+				auto handler = make_shared<HTTP::Handler>(URL{url.c_str()});
+				auto sink = make_shared<HTTP::MemorySink>(1048576);
+				return [handler,sink](){
+					int rc = handler->perform(HTTP::Get,"",*sink);
+					return rc >= 200 && rc <= 299;
+				};
+			}
+		},
+		{
+			"ring-sink",
+			"/blob/",
+			[](const string &url) -> Call {
+				// Same transfer as 'perform', read from another thread through the ring buffer.
+				auto handler = make_shared<HTTP::Handler>(URL{url.c_str()});
+				return [handler](){
+					HTTP::RingBufferSink sink;
+					std::thread consumer{[&sink](){
+						char buffer[16384];
+						try {
+							while(sink.read(buffer,sizeof(buffer)));
+						} catch(...) {
+						}
+					}};
+					int rc = 0;
+					try {
+						rc = handler->perform(HTTP::Get,"",sink);
+					} catch(...) {
+						sink.abort(ECANCELED);
+					}
+					consumer.join();
+					return rc >= 200 && rc <= 299;
+				};
+			}
+		},
+		{
+			"hash-sink",
+			"/blob/",
+			[](const string &url) -> Call {
+				// Same transfer as 'perform', keeping only the response digest.
+				auto handler = make_shared<HTTP::Handler>(URL{url.c_str()});
+				return [handler](){
+					HTTP::HashSink sink{"sha256"};
+					int rc = handler->perform(HTTP::Get,"",sink);
+					return rc >= 200 && rc <= 299 && *sink.hex();
+				};
+			}
+		},
+		{
+			"get-value",
+			"/json/",
+			[](const string &url) -> Call {
+				auto handler = make_shared<HTTP::Handler>(URL{url.c_str()});
+				return [handler](){
+					Udjat::Value value;
+					return handler->get(value);
+				};
+			}
+		},
+		{
+			"get-value-stream",
+			"/json/",
+			[](const string &url) -> Call {
+				auto handler = make_shared<HTTP::Handler>(URL{url.c_str()});
+				auto filter = make_shared<vector<string>>();
+				return [handler,filter](){
+					Udjat::Value value;
+					return handler->get(value,HTTP::Get,"",*filter);
+				};
+			}
+		},
+		{
+			"tempfile",
+			"/blob/",
+			[](const string &url) -> Call {
+				return [url](){
+					string filename = URL{url.c_str()}.tempfile([](double, double){
+						return false;
+					});
+					if(filename.empty()) {
+						return false;
+					}
+					unlink(filename.c_str());
+					return true;
+				};
+			}
+		},
+		{
+			"file-sink",
+			"/blob/",
+			[](const string &url) -> Call {
+				// Same result as 'tempfile', the response goes straight into an unnamed file.
+				auto handler = make_shared<HTTP::Handler>(URL{url.c_str()});
+				auto filename = make_shared<string>(string{"/tmp/udjat-benchmark-"} + std::to_string(getpid()) + "-" + std::to_string((uintptr_t) handler.get()));
+				return [handler,filename](){
+					HTTP::FileSink sink{"/tmp"};
+					int rc = handler->perform(HTTP::Get,"",sink);
+					if(rc < 200 || rc > 299) {
+						return false;
+					}
+					sink.save(filename->c_str());
+					unlink(filename->c_str());
+					return true;
+				};
+			}
+		},
+	};
+
+	for(bool keepalive : {true, false}) {
+
+		Server server{keepalive};
+
+		for(const auto &benchmark : benchmarks) {
+			if(!selected(benchmark.name)) {
+				continue;
+			}
+			for(size_t payload : payloads) {
+				for(size_t concurrency : concurrencies) {
+					run(benchmark.name,benchmark.path,payload,concurrency,keepalive,server,benchmark.setup);
+				}
+			}
+		}
+
+		if(selected("spool-replay")) {
+			replay(1024,keepalive,server);
+		}
+
+	}
+
+	if(selected("agent-refresh")) {
+		// Every cached handler keeps its connection open, more than the server workers with keep-alive.
+		Server server{false};
+		agents(options.agents,server);
+	}
+
+	return 0;
+
+ }
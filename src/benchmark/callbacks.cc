@@ -0,0 +1,342 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Microbenchmarks for the transfer callbacks and the JSON loader.
+  *
+  * Drives HTTP::Context::header_callback, read_callback and write_callback
+  * and the json-c to Udjat::Value conversion with synthetic inputs, without
+  * network, writing one JSON object per case on stdout (ns/op, heap
+  * allocations/op and bytes/op; writer calls per MB for the downloads).
+  *
+  * Options:
+  *
+  *  --quick          Shorter runs, for CI.
+  *  --filter=NAME    Run only the cases with NAME on the benchmark name.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <udjat/tools/url.h>
+ #include <udjat/tools/url/handler/http.h>
+ #include <udjat/tools/value.h>
+ #include <private/context.h>
+ #include <private/json.h>
+ #include "allocations.h"
+ #include <chrono>
+ #include <cstdio>
+ #include <cstring>
+ #include <functional>
+ #include <iostream>
+ #include <string>
+ #include <vector>
+
+ #if defined(HAVE_JSON_C)
+	#include <json.h>
+ #endif // HAVE_JSON_C
+
+ using namespace Udjat;
+ using namespace std;
+
+ namespace Benchmark {
+
+	static struct {
+		double seconds = 0.5;		///< @brief Minimum measuring time of each case.
+		const char *filter = nullptr;
+	} options;
+
+	static bool selected(const char *name) noexcept {
+		return !options.filter || strstr(name,options.filter);
+	}
+
+	/// @brief Run 'op' until the minimum time has elapsed, report the cost of each call.
+	static void measure(const char *name, const string &input, const std::function<void()> &op) {
+
+		if(!selected(name)) {
+			return;
+		}
+
+		op();	// Warm up.
+
+		uint64_t iterations = 0;
+		uint64_t count = allocations.count;
+		uint64_t bytes = allocations.bytes;
+
+		auto begin = chrono::steady_clock::now();
+		double elapsed = 0;
+
+		for(uint64_t batch = 1; elapsed < options.seconds; batch *= 2) {
+			for(uint64_t ix = 0; ix < batch; ix++) {
+				op();
+			}
+			iterations += batch;
+			elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		}
+
+		printf(
+			"{\"benchmark\":\"%s\",\"input\":\"%s\",\"iterations\":%llu,\"ns-per-op\":%.1f,"
+			"\"allocations-per-op\":%.2f,\"bytes-per-op\":%.1f}\n",
+			name,
+			input.c_str(),
+			(unsigned long long) iterations,
+			(elapsed * 1e9) / iterations,
+			((double) (allocations.count - count)) / iterations,
+			((double) (allocations.bytes - bytes)) / iterations
+		);
+		fflush(stdout);
+
+	}
+
+ }
+
+ namespace Udjat {
+
+	namespace HTTP {
+
+		class UDJAT_PRIVATE Microbenchmark {
+		private:
+			HTTP::Handler handler{URL{"http://127.0.0.1/"}};
+
+			/// @brief Response writer, counts the bytes received.
+			uint64_t received = 0;
+			const std::function<bool(uint64_t current, uint64_t total, const void *data, size_t len)> writer{
+				[this](uint64_t, uint64_t, const void *, size_t len) {
+					received += len;
+					return false;
+				}
+			};
+
+			Context context{handler,writer};
+
+		public:
+
+			/// @brief A response header block: status line, 'count' headers, Content-Length and the empty line.
+			void headers(size_t count) {
+
+				static const char *common[] = {
+					"Date: Mon, 06 Jan 2025 12:00:00 GMT",
+					"Server: Apache/2.4.62 (Unix)",
+					"Content-Type: application/json; charset=utf-8",
+					"Cache-Control: no-cache, no-store, must-revalidate",
+					"ETag: \"5f1c2d3e-4a5b6c7d\"",
+					"Last-Modified: Sun, 05 Jan 2025 08:30:00 GMT",
+					"Vary: Accept-Encoding",
+					"Connection: keep-alive",
+				};
+
+				vector<string> lines;
+				lines.push_back("HTTP/1.1 200 OK\r\n");
+				for(size_t ix = 0; ix < count; ix++) {
+					if(ix < (sizeof(common)/sizeof(common[0]))) {
+						lines.push_back(string{common[ix]} + "\r\n");
+					} else {
+						lines.push_back("X-Custom-Header-" + std::to_string(ix) + ":  value-" + std::to_string(ix * 31) + " \r\n");
+					}
+				}
+				lines.push_back("Content-Length: 1048576\r\n");
+				lines.push_back("\r\n");
+
+				Benchmark::measure("header_callback",string{"headers="} + std::to_string(count),[this,&lines](){
+					context.start();
+					for(auto &line : lines) {
+						Context::header_callback((char *) line.data(),1,line.size(),&context);
+					}
+				});
+
+			}
+
+			/// @brief Send a request body of 'length' bytes in blocks of 'block' bytes.
+			void upload(size_t length, size_t block) {
+
+				vector<char> buffer(block);
+				string input = string{"length="} + std::to_string(length) + ",block=" + std::to_string(block);
+
+				context.payload.text = string(length,'x');
+				Benchmark::measure("read_callback",input,[this,&buffer](){
+					context.payload.ptr = nullptr;
+					while(Context::read_callback(buffer.data(),1,buffer.size(),&context));
+				});
+				context.payload.text.clear();
+
+				// Same body from an application producer.
+				size_t sent = 0;
+				handler.body([&sent,length](char *buffer, size_t size) -> size_t {
+					size_t len = min(size,length-sent);
+					memset(buffer,'x',len);
+					sent += len;
+					return len;
+				});
+
+				Benchmark::measure("read_callback-producer",input,[this,&buffer,&sent](){
+					sent = 0;
+					while(Context::read_callback(buffer.data(),1,buffer.size(),&context));
+				});
+
+				handler.body(nullptr);
+
+			}
+
+			/// @brief Receive a response of 'length' bytes in chunks of 'chunk' bytes.
+			/// @param coalesce Size of the write coalescing buffer (0 to disable).
+			void download(size_t length, size_t chunk, size_t coalesce) {
+
+				vector<char> data(chunk,'x');
+				string input{string{"length="} + std::to_string(length) + ",chunk=" + std::to_string(chunk) + ",coalesce=" + std::to_string(coalesce)};
+
+				context.buffer.data.resize(coalesce);
+				Benchmark::measure(
+					"write_callback",
+					input,
+					[this,&data,length](){
+						context.start();
+						context.total = length;
+						for(size_t offset = 0; offset < length; offset += data.size()) {
+							Context::write_callback(data.data(),1,min(data.size(),length-offset),&context);
+						}
+						context.flush();
+					}
+				);
+
+				if(Benchmark::selected("write_callback")) {
+					// Writer calls of the last transfer, what the coalescing buffer saves.
+					printf(
+						"{\"benchmark\":\"write_callback-calls\",\"input\":\"%s\",\"calls-per-mb\":%.1f}\n",
+						input.c_str(),
+						((double) context.buffer.calls * 1048576.0) / length
+					);
+					fflush(stdout);
+				}
+
+				context.buffer.data.clear();
+
+			}
+
+		};
+
+	}
+
+ }
+
+#if defined(HAVE_JSON_C)
+
+ namespace Benchmark {
+
+	/// @brief Convert a parsed document to a value.
+	static void load(const char *name, const string &input, const string &text) {
+
+		// Deep documents are above the default json-c nesting limit.
+		json_tokener *tokener = json_tokener_new_ex(4096);
+		struct json_object *jobj = json_tokener_parse_ex(tokener,text.c_str(),text.size());
+		json_tokener_free(tokener);
+
+		if(!jobj) {
+			cerr << name << ": Can't parse " << input << endl;
+			return;
+		}
+
+		measure(name,input,[jobj](){
+			Udjat::Value value;
+			HTTP::load(value,jobj);
+		});
+
+		json_object_put(jobj);
+
+	}
+
+	static void documents() {
+
+		// Wide object.
+		{
+			string text{"{"};
+			for(size_t ix = 0; ix < 1000; ix++) {
+				text += (ix ? ",\"key" : "\"key") + std::to_string(ix) + "\":" + std::to_string(ix * 3);
+			}
+			text += "}";
+			load("load","object,keys=1000",text);
+		}
+
+		// Array of records, as in an API response.
+		{
+			string text{"{\"items\":["};
+			for(size_t ix = 0; ix < 1000; ix++) {
+				text += (ix ? ",{" : "{");
+				text += "\"id\":" + std::to_string(ix) + ",\"name\":\"item-" + std::to_string(ix) + "\",\"value\":" + std::to_string(ix) + ".5,\"enabled\":true}";
+			}
+			text += "]}";
+			load("load","array,items=1000",text);
+		}
+
+		// Deeply nested.
+		for(size_t depth : {32, 512}) {
+			string text;
+			for(size_t ix = 0; ix < depth; ix++) {
+				text += "{\"child\":";
+			}
+			text += "\"leaf\"";
+			text.append(depth,'}');
+			load("load",string{"nested,depth="} + std::to_string(depth),text);
+		}
+
+	}
+
+ }
+
+#endif // HAVE_JSON_C
+
+ using namespace Benchmark;
+
+ int main(int argc, char **argv) {
+
+	for(int arg = 1; arg < argc; arg++) {
+		if(!strcmp(argv[arg],"--quick")) {
+			options.seconds = 0.05;
+		} else if(!strncmp(argv[arg],"--filter=",9)) {
+			options.filter = argv[arg]+9;
+		} else {
+			cerr << "Usage: " << argv[0] << " [--quick] [--filter=NAME]" << endl;
+			return 2;
+		}
+	}
+
+	{
+		HTTP::Microbenchmark callbacks;
+
+		for(size_t count : {8, 32, 128}) {
+			callbacks.headers(count);
+		}
+
+		for(size_t length : {1024, 65536, 1048576}) {
+			callbacks.upload(length,65536);
+		}
+
+		for(size_t chunk : {1024, 16384}) {
+			for(size_t coalesce : {0, 65536}) {
+				callbacks.download(1048576,chunk,coalesce);
+			}
+		}
+
+	}
+
+#if defined(HAVE_JSON_C)
+	documents();
+#endif // HAVE_JSON_C
+
+	return 0;
+
+ }
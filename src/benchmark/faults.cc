@@ -0,0 +1,235 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Timeout and error handling under injected faults.
+  *
+  * Runs requests against a loopback server that delays, stalls, throttles,
+  * truncates or resets its responses, and checks the result and the time
+  * the client took to give up. Writes one JSON object per scenario on stdout,
+  * exits with 1 if any scenario ends in an unexpected way.
+  *
+  * Options:
+  *
+  *  --quick          One request per scenario, for CI runs.
+  *  --requests=N     Requests per scenario.
+  *  --filter=NAME    Run only the scenarios with NAME on the name.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <udjat/tools/url.h>
+ #include <udjat/tools/url/handler/http.h>
+ #include "server.h"
+ #include <algorithm>
+ #include <chrono>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <functional>
+ #include <iostream>
+ #include <string>
+ #include <unistd.h>
+ #include <sys/socket.h>
+ #include <netinet/in.h>
+ #include <arpa/inet.h>
+
+ using namespace Udjat;
+ using namespace std;
+
+ namespace Benchmark {
+
+	static struct {
+		size_t requests = 3;
+		const char *filter = nullptr;
+	} options;
+
+	/// @brief A fault and the expected client behavior.
+	struct Scenario {
+		const char *name;
+		Faults faults;
+		size_t payload = 65536;
+
+		/// @brief Handler deadlines (in seconds, 0 for the default).
+		unsigned int timeout = 0;
+		struct {
+			unsigned int limit = 0;
+			unsigned int time = 0;
+		} lowspeed;
+
+		bool success;			///< @brief The request should succeed (2xx).
+		double limit;			///< @brief The client must finish before this time (in seconds).
+	};
+
+	/// @brief Get an URL on a closed port.
+	static string refused() {
+
+		int sock = socket(AF_INET,SOCK_STREAM,0);
+
+		struct sockaddr_in addr;
+		memset(&addr,0,sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		socklen_t length = sizeof(addr);
+		if(sock < 0 || bind(sock,(struct sockaddr *) &addr,sizeof(addr)) || getsockname(sock,(struct sockaddr *) &addr,&length)) {
+			throw runtime_error("Can't get a free port");
+		}
+		::close(sock);
+
+		char buffer[64];
+		snprintf(buffer,sizeof(buffer),"http://127.0.0.1:%u/blob/1024",(unsigned int) ntohs(addr.sin_port));
+		return buffer;
+
+	}
+
+	/// @brief Run scenario, report results.
+	/// @return true if every request behaved as expected.
+	static bool run(const Scenario &scenario, const string &url) {
+
+		vector<double> times;
+		size_t succeeded = 0;
+		size_t unexpected = 0;
+		int last = 0;
+		uint64_t received = 0;
+
+		for(size_t request = 0; request < options.requests; request++) {
+
+			HTTP::Handler handler{URL{url.c_str()}};
+			handler.timeout(scenario.timeout);
+			if(scenario.lowspeed.limit) {
+				handler.lowspeed(scenario.lowspeed.limit,scenario.lowspeed.time);
+			}
+
+			received = 0;
+			std::function<bool(uint64_t, uint64_t, const void *, size_t)> writer{[&received](uint64_t, uint64_t, const void *, size_t length){
+				received += length;
+				return false;
+			}};
+
+			auto begin = chrono::steady_clock::now();
+			last = handler.test(HTTP::Get,"",writer);
+			double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+			times.push_back(seconds);
+
+			bool success = (last >= 200 && last <= 299);
+			if(success) {
+				succeeded++;
+			}
+
+			if(success != scenario.success || seconds > scenario.limit) {
+				unexpected++;
+			}
+
+		}
+
+		sort(times.begin(),times.end());
+
+		printf(
+			"{\"scenario\":\"%s\",\"latency-ms\":%u,\"stall-ms\":%u,\"bandwidth\":%zu,\"truncate\":%ld,\"reset\":%s,"
+			"\"timeout\":%u,\"low-speed-limit\":%u,\"low-speed-time\":%u,"
+			"\"requests\":%zu,\"succeeded\":%zu,\"last-result\":%d,\"last-received\":%llu,"
+			"\"seconds\":{\"min\":%.3f,\"max\":%.3f},\"expected\":\"%s within %.1fs\",\"unexpected\":%zu}\n",
+			scenario.name,
+			scenario.faults.latency,
+			scenario.faults.stall,
+			scenario.faults.bandwidth,
+			scenario.faults.truncate,
+			(scenario.faults.reset ? "true" : "false"),
+			scenario.timeout,
+			scenario.lowspeed.limit,
+			scenario.lowspeed.time,
+			options.requests,
+			succeeded,
+			last,
+			(unsigned long long) received,
+			(times.empty() ? 0.0 : times.front()),
+			(times.empty() ? 0.0 : times.back()),
+			(scenario.success ? "success" : "failure"),
+			scenario.limit,
+			unexpected
+		);
+		fflush(stdout);
+
+		return unexpected == 0;
+
+	}
+
+ }
+
+ using namespace Benchmark;
+
+ int main(int argc, char **argv) {
+
+	for(int arg = 1; arg < argc; arg++) {
+		if(!strcmp(argv[arg],"--quick")) {
+			options.requests = 1;
+		} else if(!strncmp(argv[arg],"--requests=",11)) {
+			options.requests = max(strtoul(argv[arg]+11,nullptr,10),1UL);
+		} else if(!strncmp(argv[arg],"--filter=",9)) {
+			options.filter = argv[arg]+9;
+		} else {
+			cerr << "Usage: " << argv[0] << " [--quick] [--requests=N] [--filter=NAME]" << endl;
+			return 2;
+		}
+	}
+
+	static const Scenario scenarios[] = {
+		{ "baseline",			Faults{},									65536,	2,	{0,0},		true,	1.0	},
+		{ "latency",			Faults{200,0,0,-1,false},					65536,	2,	{0,0},		true,	1.0	},
+		{ "latency-timeout",	Faults{5000,0,0,-1,false},					65536,	1,	{0,0},		false,	2.5	},
+		{ "stalled-headers",	Faults{0,5000,0,-1,false},					65536,	1,	{0,0},		false,	2.5	},
+		{ "bandwidth",			Faults{0,0,1048576,-1,false},				262144,	5,	{0,0},		true,	2.0	},
+		{ "bandwidth-timeout",	Faults{0,0,65536,-1,false},					1048576,1,	{0,0},		false,	2.5	},
+		{ "low-speed",			Faults{0,0,4096,-1,false},					1048576,10,	{16384,1},	false,	3.5	},
+		{ "truncated",			Faults{0,0,0,32768,false},					65536,	2,	{0,0},		false,	1.0	},
+		{ "empty-body",			Faults{0,0,0,0,false},						65536,	2,	{0,0},		false,	1.0	},
+		{ "reset",				Faults{0,0,0,-1,true},						65536,	2,	{0,0},		false,	1.0	},
+	};
+
+	bool ok = true;
+
+	for(const auto &scenario : scenarios) {
+
+		if(options.filter && !strstr(scenario.name,options.filter)) {
+			continue;
+		}
+
+		Server server{true,4,scenario.faults};
+
+		char path[64];
+		snprintf(path,sizeof(path),"/blob/%zu",scenario.payload);
+
+		if(!run(scenario,server.url(path))) {
+			ok = false;
+		}
+
+	}
+
+	if(!options.filter || strstr("refused",options.filter)) {
+		Scenario scenario{"refused",Faults{},1024,2,{0,0},false,1.0};
+		if(!run(scenario,refused())) {
+			ok = false;
+		}
+	}
+
+	return ok ? 0 : 1;
+
+ }
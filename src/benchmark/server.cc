@@ -0,0 +1,352 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements the loopback HTTP/1.1 server used by the benchmarks.
+  */
+
+ #include "server.h"
+ #include <cstring>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <system_error>
+ #include <chrono>
+ #include <unistd.h>
+ #include <sys/socket.h>
+ #include <netinet/in.h>
+ #include <netinet/tcp.h>
+ #include <arpa/inet.h>
+
+ using namespace std;
+
+ namespace Benchmark {
+
+	Server::Server(bool k, size_t threads, const Faults &f) : keepalive{k}, faults{f} {
+
+		sock = socket(AF_INET,SOCK_STREAM|SOCK_CLOEXEC,0);
+		if(sock < 0) {
+			throw system_error(errno,system_category(),"Cant create server socket");
+		}
+
+		int on = 1;
+		setsockopt(sock,SOL_SOCKET,SO_REUSEADDR,&on,sizeof(on));
+
+		struct sockaddr_in addr;
+		memset(&addr,0,sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+
+		socklen_t length = sizeof(addr);
+		if(bind(sock,(struct sockaddr *) &addr,sizeof(addr)) || listen(sock,1024) || getsockname(sock,(struct sockaddr *) &addr,&length)) {
+			int err = errno;
+			::close(sock);
+			throw system_error(err,system_category(),"Cant start loopback server");
+		}
+
+		port = ntohs(addr.sin_port);
+
+		// Every worker accepts and serves one connection at a time.
+		for(size_t ix = 0; ix < threads; ix++) {
+			workers.emplace_back([this](){
+				run();
+			});
+		}
+
+	}
+
+	Server::~Server() {
+
+		::shutdown(sock,SHUT_RDWR);
+
+		{
+			lock_guard<mutex> lock{guard};
+			enabled = false;
+			wakeup.notify_all();
+			for(int fd : connections) {
+				::shutdown(fd,SHUT_RDWR);
+			}
+		}
+
+		for(auto &worker : workers) {
+			worker.join();
+		}
+
+		::close(sock);
+
+	}
+
+	string Server::url(const char *path) const {
+		char buffer[64];
+		snprintf(buffer,sizeof(buffer),"http://127.0.0.1:%u",(unsigned int) port);
+		return string{buffer} + path;
+	}
+
+	const string & Server::document(char kind, size_t length) {
+
+		lock_guard<mutex> lock{guard};
+
+		string &doc = documents[make_pair(kind,length)];
+		if(doc.empty() && length) {
+
+			if(kind == 'j') {
+
+				// Array of small objects, the usual shape of an API response.
+				doc.reserve(length+64);
+				doc = "{\"items\":[";
+				char item[96];
+				for(unsigned int ix = 0; doc.size() < length; ix++) {
+					snprintf(item,sizeof(item),"%s{\"id\":%u,\"name\":\"item-%08u\",\"value\":%u.5,\"enabled\":%s}",
+						(ix ? "," : ""), ix, ix, ix * 7, ((ix & 1) ? "true" : "false")
+					);
+					doc += item;
+				}
+				doc += "]}";
+
+			} else {
+
+				doc.resize(length);
+				for(size_t ix = 0; ix < length; ix++) {
+					doc[ix] = 'a' + (ix % 26);
+				}
+
+			}
+
+		}
+
+		return doc;
+
+	}
+
+	bool Server::sleep(unsigned int milliseconds) {
+		unique_lock<mutex> lock{guard};
+		return !wakeup.wait_for(lock,chrono::milliseconds(milliseconds),[this](){
+			return !enabled;
+		});
+	}
+
+	static bool send_all(int fd, const char *data, size_t length, int flags = 0) {
+		while(length) {
+			ssize_t bytes = ::send(fd,data,length,flags|MSG_NOSIGNAL);
+			if(bytes <= 0) {
+				return false;
+			}
+			data += bytes;
+			length -= bytes;
+		}
+		return true;
+	}
+
+	void Server::run() {
+
+		while(enabled) {
+
+			int fd = ::accept4(sock,nullptr,nullptr,SOCK_CLOEXEC);
+			if(fd < 0) {
+				if(errno == EINTR || errno == ECONNABORTED) {
+					continue;
+				}
+				break;
+			}
+
+			int on = 1;
+			setsockopt(fd,IPPROTO_TCP,TCP_NODELAY,&on,sizeof(on));
+
+			{
+				lock_guard<mutex> lock{guard};
+				if(!enabled) {
+					::close(fd);
+					break;
+				}
+				connections.insert(fd);
+			}
+
+			serve(fd);
+
+			{
+				lock_guard<mutex> lock{guard};
+				connections.erase(fd);
+			}
+
+			::close(fd);
+
+		}
+
+	}
+
+	void Server::serve(int fd) {
+
+		char buffer[16384];
+		size_t used = 0;
+
+		while(enabled) {
+
+			// Wait for the request headers.
+			char *end;
+			while(!(end = (char *) memmem(buffer,used,"\r\n\r\n",4))) {
+				if(used == sizeof(buffer)) {
+					return;
+				}
+				ssize_t bytes = ::recv(fd,buffer+used,sizeof(buffer)-used,0);
+				if(bytes <= 0) {
+					return;
+				}
+				used += bytes;
+			}
+
+			*end = 0;
+			size_t header = (end - buffer) + 4;
+
+			bool head = (strncmp(buffer,"HEAD ",5) == 0);
+			bool expect = false;
+			size_t body = 0;
+
+			char kind = 0;
+			size_t length = 0;
+
+			{
+				const char *path = strchr(buffer,' ');
+				if(path) {
+					path++;
+					if(strncmp(path,"/blob/",6) == 0) {
+						kind = 'b';
+						length = strtoul(path+6,nullptr,10);
+					} else if(strncmp(path,"/json/",6) == 0) {
+						kind = 'j';
+						length = strtoul(path+6,nullptr,10);
+					}
+				}
+			}
+
+			for(char *line = strstr(buffer,"\r\n"); line; line = strstr(line,"\r\n")) {
+				line += 2;
+				if(strncasecmp(line,"content-length:",15) == 0) {
+					body = strtoul(line+15,nullptr,10);
+				} else if(strncasecmp(line,"expect:",7) == 0) {
+					expect = true;
+				}
+			}
+
+			if(expect && body && !send_all(fd,"HTTP/1.1 100 Continue\r\n\r\n",25)) {
+				return;
+			}
+
+			// Discard the request body.
+			size_t available = used - header;
+			if(available >= body) {
+				used -= (header + body);
+				memmove(buffer,buffer+header+body,used);
+			} else {
+				body -= available;
+				used = 0;
+				while(body) {
+					ssize_t bytes = ::recv(fd,buffer,min(body,sizeof(buffer)),0);
+					if(bytes <= 0) {
+						return;
+					}
+					body -= bytes;
+				}
+			}
+
+			if(faults.reset) {
+				// Close with RST.
+				struct linger linger{1,0};
+				setsockopt(fd,SOL_SOCKET,SO_LINGER,&linger,sizeof(linger));
+				return;
+			}
+
+			if(faults.latency && !sleep(faults.latency)) {
+				return;
+			}
+
+			// Send the response, when keep-alive is disabled the client closes the connection.
+			char response[256];
+			int len;
+			const string *doc = nullptr;
+
+			if(kind) {
+				doc = &document(kind,length);
+				len = snprintf(
+						response,sizeof(response),
+						"HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: %s\r\n\r\n",
+						(kind == 'j' ? "application/json" : "application/octet-stream"),
+						doc->size(),
+						(keepalive ? "keep-alive" : "close")
+					);
+			} else {
+				len = snprintf(
+						response,sizeof(response),
+						"HTTP/1.1 204 No Content\r\nConnection: %s\r\n\r\n",
+						(keepalive ? "keep-alive" : "close")
+					);
+			}
+
+			bool content = (doc && !head && !doc->empty());
+
+			if(faults.stall) {
+
+				// Status line, then wait before the other headers.
+				const char *eol = strstr(response,"\r\n") + 2;
+				if(!send_all(fd,response,eol-response) || !sleep(faults.stall) || !send_all(fd,eol,len-(eol-response))) {
+					return;
+				}
+
+			} else if(!send_all(fd,response,len,content ? MSG_MORE : 0)) {
+
+				return;
+
+			}
+
+			if(content) {
+
+				size_t length = doc->size();
+				if(faults.truncate >= 0 && (size_t) faults.truncate < length) {
+					length = (size_t) faults.truncate;
+				}
+
+				if(faults.bandwidth) {
+
+					// Send a twentieth of the rate each 50ms.
+					size_t block = std::max(faults.bandwidth / 20, (size_t) 1);
+					for(size_t offset = 0; offset < length; offset += block) {
+						if(!send_all(fd,doc->data()+offset,std::min(block,length-offset)) || !sleep(50)) {
+							return;
+						}
+					}
+
+				} else if(!send_all(fd,doc->data(),length)) {
+
+					return;
+
+				}
+
+				if(length < doc->size()) {
+					// Truncated body, close the connection.
+					return;
+				}
+
+			}
+
+			served++;
+
+		}
+
+	}
+
+ }
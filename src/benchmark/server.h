@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Declare the loopback HTTP/1.1 server used by the benchmarks.
+  */
+
+ #pragma once
+ #include <cstdint>
+ #include <cstddef>
+ #include <string>
+ #include <vector>
+ #include <map>
+ #include <set>
+ #include <thread>
+ #include <mutex>
+ #include <condition_variable>
+ #include <atomic>
+
+ namespace Benchmark {
+
+	/// @brief Failures injected on every response.
+	struct Faults {
+		unsigned int latency = 0;		///< @brief Delay before the response (in milliseconds).
+		unsigned int stall = 0;			///< @brief Pause after the status line (in milliseconds).
+		size_t bandwidth = 0;			///< @brief Response body rate in bytes per second (0 for unlimited).
+		long truncate = -1;				///< @brief Close the connection after this number of body bytes (-1 to send all).
+		bool reset = false;				///< @brief Reset the connection instead of answering.
+	};
+
+	/// @brief Minimal in-process HTTP/1.1 server bound to 127.0.0.1.
+	/// @details Serves generated documents, the request path selects the kind and length:
+	/// '/blob/<length>' returns 'length' bytes of application/octet-stream,
+	/// '/json/<length>' returns a JSON object of about 'length' bytes,
+	/// any other path accepts the request body and answers '204 No Content'.
+	class Server {
+	private:
+		int sock = -1;
+		uint16_t port = 0;
+
+		/// @brief Keep connections open between requests.
+		const bool keepalive;
+
+		const Faults faults;
+
+		std::atomic<bool> enabled{true};
+		std::atomic<uint64_t> served{0};
+
+		std::mutex guard;
+		std::condition_variable wakeup;
+
+		/// @brief Open client connections, shut down on destruction.
+		std::set<int> connections;
+
+		/// @brief Generated documents, by kind and length.
+		std::map<std::pair<char,size_t>,std::string> documents;
+
+		std::vector<std::thread> workers;
+
+		/// @brief Get (or build) a document.
+		const std::string & document(char kind, size_t length);
+
+		/// @brief Accept connections until disabled.
+		void run();
+
+		/// @brief Serve requests from a connection until closed.
+		void serve(int fd);
+
+		/// @brief Wait, unless the server is stopped.
+		/// @return false if the server was stopped.
+		bool sleep(unsigned int milliseconds);
+
+	public:
+
+		/// @brief Start server.
+		/// @param keepalive Keep connections open between requests.
+		/// @param threads Number of connections served at the same time.
+		/// @param faults Failures injected on every response.
+		Server(bool keepalive = true, size_t threads = 64, const Faults &faults = Faults{});
+		~Server();
+
+		Server(const Server &) = delete;
+		Server & operator=(const Server &) = delete;
+
+		/// @brief Get the URL for a path on this server.
+		std::string url(const char *path) const;
+
+		/// @brief Get number of requests served.
+		inline uint64_t requests() const noexcept {
+			return served.load();
+		}
+
+	};
+
+ }
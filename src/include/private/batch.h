@@ -0,0 +1,128 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Declare payload batching for actions.
+  */
+
+ #pragma once
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/histogram.h>
+ #include <atomic>
+ #include <string>
+ #include <list>
+ #include <utility>
+ #include <thread>
+ #include <mutex>
+ #include <condition_variable>
+ #include <functional>
+
+ namespace Udjat {
+
+ 	namespace HTTP {
+
+		/// @brief Accumulate payloads and send them as a single request.
+		class UDJAT_PRIVATE Batch {
+		public:
+
+			/// @brief How the payloads are joined.
+			enum Framing : uint8_t {
+				NDJson,		///< @brief One payload per line (application/x-ndjson).
+				JsonArray,	///< @brief Payloads as elements of a JSON array (application/json).
+			};
+
+			/// @brief Get framing from name.
+			static Framing FramingFactory(const char *name);
+
+			/// @brief Flush thresholds.
+			struct Limits {
+				size_t items = 100;			///< @brief Maximum payloads on a batch.
+				size_t bytes = 1048576;		///< @brief Maximum batch length.
+				unsigned int interval = 1000;	///< @brief Maximum time a payload waits (in milliseconds).
+			};
+
+			/// @brief Batch metrics.
+			struct Metrics {
+				size_t pending = 0;			///< @brief Payloads waiting for the next flush.
+				uint64_t flushes = 0;		///< @brief Requests sent.
+				uint64_t items = 0;			///< @brief Payloads sent.
+				uint64_t failed = 0;		///< @brief Requests sent with error.
+				Histogram::Summary latency;	///< @brief Flush latency (in microseconds).
+			};
+
+		private:
+
+			const Framing framing;
+			const Limits limits;
+
+			/// @brief Send the batch, return true on success.
+			const std::function<bool(const std::string &body, const char *mimetype)> send;
+
+			std::mutex guard;
+			std::condition_variable cond;
+
+			std::string body;
+			size_t items = 0;
+			bool enabled = true;
+
+			/// @brief Closed batches waiting for the flusher.
+			std::list<std::pair<std::string,size_t>> ready;
+
+			/// @brief Move the current batch to the ready list, called with the lock.
+			void close();
+
+			struct {
+				std::atomic<uint64_t> flushes{0};
+				std::atomic<uint64_t> items{0};
+				std::atomic<uint64_t> failed{0};
+			} counters;
+
+			Histogram latency;
+
+			std::thread flusher;
+
+			/// @brief Send the batch, called without the lock.
+			void flush(std::string &body, size_t items) noexcept;
+
+		public:
+
+			/// @brief Create batch and start the flusher thread.
+			/// @param framing How the payloads are joined.
+			/// @param limits The flush thresholds.
+			/// @param send Send the batch with its Content-Type, return true on success.
+			Batch(Framing framing, const Limits &limits, const std::function<bool(const std::string &body, const char *mimetype)> &send);
+
+			/// @brief Send the pending payloads and stop the flusher.
+			~Batch();
+
+			/// @brief Get the Content-Type of the batches.
+			const char * mimetype() const noexcept;
+
+			/// @brief Add payload to the batch.
+			void push(const std::string &payload);
+
+			/// @brief Get batch metrics.
+			Metrics metrics() noexcept;
+
+		};
+
+	}
+
+ }
@@ -0,0 +1,81 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Declare sampled payload capture.
+  */
+
+ #pragma once
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <cstdint>
+ #include <cstddef>
+ #include <memory>
+ #include <string>
+
+ namespace Udjat {
+
+ 	namespace HTTP {
+
+		/// @brief Request and response bodies of a sampled transfer ([http] trace-payload).
+		class UDJAT_PRIVATE Capture {
+		private:
+
+			/// @brief Captured bytes and total length of a body.
+			struct Body {
+				std::string data;
+				uint64_t length = 0;
+			};
+
+			Body request;
+			Body response;
+
+			/// @brief Bytes kept of each body.
+			const size_t limit;
+
+			static void append(Body &body, const void *data, size_t length, size_t limit) noexcept;
+
+		public:
+			Capture(size_t limit);
+
+			/// @brief Sample the next transfer.
+			/// @return The capture if this transfer was selected, nullptr if not.
+			static std::unique_ptr<Capture> sample() noexcept;
+
+			/// @brief Request body block sent.
+			inline void sent(const void *data, size_t length) noexcept {
+				append(request,data,length,limit);
+			}
+
+			/// @brief Response body block received.
+			inline void received(const void *data, size_t length) noexcept {
+				append(response,data,length,limit);
+			}
+
+			/// @brief Write the transfer to the capture file, rotating it when full.
+			/// @param method The request method.
+			/// @param url The request URL.
+			/// @param status The HTTP status or error code.
+			void write(const char *method, const char *url, int status) noexcept;
+
+		};
+
+	}
+
+ }
@@ -28,8 +28,13 @@
  #include <udjat/tools/url.h>
  #include <udjat/tools/url/handler.h>
  #include <udjat/tools/url/handler/http.h>
+ #include <udjat/tools/http/sink.h>
+ #include <private/capture.h>
  #include <vector>
+ #include <string>
  #include <functional>
+ #include <memory>
+ #include <chrono>
  
 #if defined(HAVE_WINHTTP)
 
@@ -40,6 +45,10 @@
 
 	#include <curl/curl.h>
 
+	#ifdef HAVE_LIBCRYPTO
+		#include <openssl/evp.h>
+	#endif // HAVE_LIBCRYPTO
+
 #else
 
 	#error Cant determine HTTP engine
@@ -79,10 +88,19 @@
 		};
 #endif // _WIN32
 
+		/// @brief Drives the transfer callbacks without network (src/benchmark/callbacks.cc).
+		class Microbenchmark;
+
 		class UDJAT_PRIVATE Context {
 		private:
+			friend class Handler;
+			friend class Microbenchmark;
+
 			HTTP::Handler *handler;
-			const std::function<bool(uint64_t current, uint64_t total, const void *data, size_t len)> *write;
+			const std::function<bool(uint64_t current, uint64_t total, const void *data, size_t len)> *write = nullptr;
+
+			/// @brief Output sink, replaces the writer when set.
+			HTTP::Sink *sink = nullptr;
 
 			void set_local(const sockaddr_storage &addr) noexcept;
 			void set_remote(const sockaddr_storage &addr) noexcept;
@@ -103,8 +121,21 @@
 			uint64_t current = 0;
 			uint64_t total = 0;
 
+			/// @brief Host and port of the handler URL, the key for the transfer metrics.
+			std::string host;
+
+			/// @brief Context id on the trace ring.
+			uint32_t id;
+
+			/// @brief Transfer events are being recorded ([http] trace).
+			bool tracing = false;
+
+			/// @brief Bodies of the current transfer, only when it was sampled ([http] trace-payload).
+			std::unique_ptr<Capture> capture;
+
 			struct {
 				curl_slist *request = nullptr;
+				size_t count = 0;		///< @brief Number of handler headers on the list.
 			} headers;
 
 			struct {
@@ -117,6 +148,55 @@
 				char message[CURL_ERROR_SIZE+1] = {0};
 			} error;
 
+			/// @brief Progress notification state.
+			struct {
+				std::chrono::steady_clock::time_point last;
+				uint64_t current = 0;
+			} progress;
+
+			/// @brief Write coalescing buffer.
+			struct {
+				std::vector<uint8_t> data;
+				size_t used = 0;
+				size_t calls = 0;		///< @brief Number of writer calls on the current transfer.
+			} buffer;
+
+#ifdef HAVE_LIBCRYPTO
+			/// @brief Running digests, one for each entry in handler->digests.
+			std::vector<EVP_MD_CTX *> digests;
+#endif // HAVE_LIBCRYPTO
+
+			/// @brief Digests were finalized and checked.
+			bool verified = false;
+
+			/// @brief Start running digests.
+			void digest_init();
+
+			/// @brief Release running digests, the next transfer will not compute them.
+			void digest_reset() noexcept;
+
+			/// @brief Update running digests.
+			void digest_update(const void *data, size_t len);
+
+			/// @brief Finalize digests and compare with the expected values, throws on mismatch.
+			void digest_verify();
+
+			/// @brief Load server certificate chain, if available, into the handler.
+			void load_certificates() noexcept;
+
+			/// @brief Send data block to the writer.
+			/// @return true if the application asked to cancel the transfer.
+			bool deliver(const void *data, size_t len);
+
+			/// @brief Send buffered data to the writer.
+			/// @return true if the application asked to cancel the transfer.
+			bool flush();
+
+			/// @brief Emit progress notification if the throttle allows it.
+			/// @param force If true ignore the throttle (but not duplicated notifications).
+			/// @return true if the application asked to cancel the transfer.
+			bool notify(uint64_t current, uint64_t total, bool force = false) noexcept;
+
 			inline void system_error(int code = errno) noexcept {
 				error.system = -code;
 			}
@@ -126,6 +206,15 @@
 				strncpy(error.message,e.what(),CURL_ERROR_SIZE);
 			}
 
+			Context(HTTP::Handler &handler);
+
+			/// @brief Reset transfer state.
+			void start();
+
+			/// @brief Apply handler options, they can change between requests on the same handle.
+			/// @param multi The transfer will run on a curl multi handle.
+			void configure(bool multi = false);
+
 			int perform(bool except);
 
 			static int trace_callback(CURL *handle, curl_infotype type, char *data, size_t size, Context *context) noexcept;
@@ -138,17 +227,59 @@
 			static size_t header_callback(char *buffer, size_t size, size_t nitems, Context *context) noexcept;
 			static size_t no_write_callback(void *, size_t size, size_t nmemb, Context *context) noexcept;
 
+			/// @brief Progress of the response body, the upload counters are ignored.
+			static int xferinfo_callback(Context *context, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) noexcept;
+
+#if defined(HAVE_USDT) && LIBCURL_VERSION_NUM >= 0x075000
+			/// @brief Connection ready for the request, fires the tls__done probe.
+			static int prereq_callback(Context *context, char *primary, char *local, int primary_port, int local_port) noexcept;
+#endif // HAVE_USDT
+
 #endif
 
 		public:
 			Context(HTTP::Handler &handler, const std::function<bool(uint64_t current, uint64_t total, const void *data, size_t len)> &writer);
+			Context(HTTP::Handler &handler, HTTP::Sink &sink);
 			~Context();
 
+			/// @brief Send the response of the next transfer to a writer.
+			inline Context & bind(const std::function<bool(uint64_t current, uint64_t total, const void *data, size_t len)> &writer) noexcept {
+				write = &writer;
+				sink = nullptr;
+				return *this;
+			}
+
+			/// @brief Send the response of the next transfer to a sink.
+			inline Context & bind(HTTP::Sink &s) noexcept {
+				write = nullptr;
+				sink = &s;
+				return *this;
+			}
+
 			void set(const HTTP::Method method);
 
-			int test(const HTTP::Method method, const char *payload) noexcept;
+			/// @brief Perform request without exceptions.
+			/// @param body If true send the response body to the writer, if false discard it.
+			/// @return The HTTP status or error code.
+			int test(const HTTP::Method method, const char *payload, bool body = false) noexcept;
 			int perform(const HTTP::Method method, const char *payload);
 
+#ifdef HAVE_CURL
+			inline CURL * handle() const noexcept {
+				return hCurl;
+			}
+
+			/// @brief Prepare a test to be run on a curl multi handle, discarding the response body.
+			/// @return 0 if the transfer can be added to the multi handle, error code if not.
+			int prepare(const HTTP::Method method, const char *payload) noexcept;
+
+			/// @brief Get the result of a finished transfer.
+			/// @param res The transfer result.
+			/// @param except If true launch exception on error.
+			/// @return The HTTP status or error code.
+			int complete(CURLcode res, bool except);
+#endif // HAVE_CURL
+
 		};
 
 	}
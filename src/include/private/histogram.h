@@ -0,0 +1,88 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Declare lock-free latency histogram.
+  */
+
+ #pragma once
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <atomic>
+ #include <ctime>
+ #include <cstdint>
+
+ namespace Udjat {
+
+ 	namespace HTTP {
+
+		/// @brief Fixed memory, log bucketed (HDR style) histogram over a sliding time window.
+		class UDJAT_PRIVATE Histogram {
+		public:
+
+			/// @brief Number of buckets (16 linear, then 8 per power of two up to 2^36).
+			static constexpr size_t buckets = 16 + (32 * 8);
+
+			/// @brief Number of sub-windows.
+			static constexpr size_t slots = 4;
+
+		private:
+
+			/// @brief Sub-window, covering 'length' seconds.
+			struct Slot {
+				std::atomic<time_t> epoch{0};
+				std::atomic<uint64_t> max{0};
+				std::atomic<uint32_t> counts[buckets];
+			} slot[slots];
+
+			/// @brief Seconds covered by each slot.
+			const time_t length;
+
+			/// @brief Get bucket for value.
+			static size_t index(uint64_t value) noexcept;
+
+			/// @brief Get highest value on the bucket.
+			static uint64_t upper(size_t index) noexcept;
+
+		public:
+
+			/// @brief Create histogram.
+			/// @param window Seconds covered by the histogram.
+			Histogram(time_t window);
+
+			/// @brief Record value.
+			void record(uint64_t value) noexcept;
+
+			/// @brief Values on the window.
+			struct Summary {
+				uint64_t count = 0;
+				uint64_t p50 = 0;
+				uint64_t p90 = 0;
+				uint64_t p99 = 0;
+				uint64_t max = 0;
+			};
+
+			/// @brief Get percentiles on the window.
+			Summary summary() const noexcept;
+
+		};
+
+	}
+
+ }
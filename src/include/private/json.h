@@ -0,0 +1,138 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Declare incremental JSON parser.
+  */
+
+ #pragma once
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <string>
+ #include <vector>
+ #include <functional>
+
+ #if defined(HAVE_JSON_C)
+	struct json_object;
+ #endif // HAVE_JSON_C
+
+ namespace Udjat {
+
+	class Value;
+
+ 	namespace HTTP {
+
+#if defined(HAVE_JSON_C)
+		/// @brief Copy a parsed json-c document into a value.
+		UDJAT_PRIVATE void load(Udjat::Value &value, struct json_object *jobj);
+#endif // HAVE_JSON_C
+
+		/// @brief Incremental JSON parser, reports elements by JSON pointer without building a document.
+		class UDJAT_PRIVATE JsonParser {
+		public:
+
+			enum Event : uint8_t {
+				Object,		///< @brief Start of object.
+				Array,		///< @brief Start of array.
+				End,		///< @brief End of object or array.
+				String,		///< @brief String value (unescaped).
+				Number,		///< @brief Number value (as in the source).
+				Boolean,	///< @brief Boolean value ("true" or "false").
+				Null,		///< @brief Null value.
+			};
+
+			/// @brief Element handler.
+			/// @param event The element type.
+			/// @param pointer The JSON pointer (RFC 6901) of the element.
+			/// @param value The scalar value (empty for containers).
+			/// @return true to stop parsing.
+			using Handler = std::function<bool(Event event, const std::string &pointer, const std::string &value)>;
+
+		private:
+
+			enum State : uint8_t {
+				Value,			///< @brief Expecting a value.
+				FirstKey,		///< @brief Expecting a key or the end of an object.
+				Key,			///< @brief Expecting a key.
+				Colon,			///< @brief Expecting ':'.
+				Next,			///< @brief Expecting ',' or the end of the container.
+				Text,			///< @brief Inside string.
+				Escape,			///< @brief Inside string, after '\'.
+				Unicode,		///< @brief Inside string, reading \\uXXXX.
+				Literal,		///< @brief Inside number, true, false or null.
+				Complete,		///< @brief Top level value complete.
+			} state = Value;
+
+			/// @brief Open container.
+			struct Container {
+				bool array;
+				size_t length;	///< @brief Pointer length of the container.
+				size_t index = 0;
+				Container(bool a, size_t l) : array{a}, length{l} {
+				}
+			};
+
+			Handler handler;
+			std::vector<Container> stack;
+			std::string pointer;
+			std::string token;
+			bool key = false;			///< @brief The string being read is an object key.
+			unsigned int codepoint = 0;	///< @brief \\uXXXX accumulator.
+			unsigned int digits = 0;
+			unsigned int surrogate = 0;
+			bool stopped = false;
+
+			/// @brief Update pointer for the next array element.
+			void element();
+
+			/// @brief Report scalar, close the value.
+			bool scalar(Event event);
+
+			/// @brief Report end of literal token.
+			bool literal();
+
+			/// @brief Value is complete, expect next.
+			void complete();
+
+			/// @brief Append unicode code point to the token.
+			void append(unsigned int codepoint);
+
+		public:
+			JsonParser(const Handler &handler);
+
+			/// @brief Parse next block.
+			/// @return true if the handler asked to stop.
+			bool parse(const char *data, size_t length);
+
+			/// @brief End of input, throws if the document is incomplete.
+			void finish();
+
+			/// @brief Restart parser.
+			void reset();
+
+			/// @brief Check if the top level value is complete.
+			inline bool done() const noexcept {
+				return state == Complete;
+			}
+
+		};
+
+	}
+
+ }
@@ -0,0 +1,110 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Declare streaming response body assertions.
+  */
+
+ #pragma once
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/json.h>
+ #include <string>
+ #include <memory>
+ #include <regex>
+
+ namespace Udjat {
+
+ 	namespace HTTP {
+
+		/// @brief Checks the response body while it arrives, deciding as soon as possible.
+		class UDJAT_PRIVATE BodyMatcher {
+		private:
+
+			enum Result : uint8_t {
+				Pending,
+				Passed,
+				Failed,
+			};
+
+			/// @brief Substring assertion.
+			struct {
+				std::string text;
+				Result result = Pending;
+			} contains;
+
+			/// @brief Regular expression assertion.
+			struct {
+				std::unique_ptr<std::regex> expression;
+				Result result = Pending;
+			} matches;
+
+			/// @brief JSON pointer equality assertion.
+			struct {
+				std::string pointer;
+				std::string value;
+				Result result = Pending;
+			} json;
+
+			/// @brief Last bytes of the body, for substring and expression searches.
+			std::string window;
+
+			/// @brief Longest expression match, in bytes (body-matches-window).
+			/// @note The expression is checked once every 'limit' bytes and at finish(), its result is decided only there.
+			size_t limit;
+
+			/// @brief Window bytes already checked by the expression.
+			size_t searched = 0;
+
+			JsonParser parser;
+
+			/// @brief Get the combined result.
+			Result result() const noexcept;
+
+			/// @brief Run the expression on the window bytes not yet checked.
+			void search();
+
+			/// @brief Drop the window bytes no match can start on.
+			void trim();
+
+		public:
+			BodyMatcher(const XML::Node &node);
+
+			/// @brief Check if there are assertions.
+			inline operator bool() const noexcept {
+				return !(contains.text.empty() && !matches.expression && json.pointer.empty());
+			}
+
+			/// @brief Prepare for a new response.
+			void reset();
+
+			/// @brief Check next block of the response body.
+			/// @return true if the result is known and the transfer can stop.
+			/// @note The body-matches result is known only every body-matches-window bytes, or at finish().
+			bool write(const void *data, size_t length);
+
+			/// @brief End of response body.
+			/// @return true if all assertions have passed.
+			bool finish();
+
+		};
+
+	}
+
+ }
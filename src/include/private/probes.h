@@ -0,0 +1,66 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Static user-space tracepoints (USDT) of the transfer engine.
+  *
+  * Built with 'meson setup -Dusdt=true' (requires sys/sdt.h); otherwise the
+  * probes compile to nothing. When built, each probe is a single nop until a
+  * tracer attaches to it. Provider 'udjathttp':
+  *
+  *  context__create(uint32 id, const char *url)
+  *		A transfer context was created.
+  *
+  *  connect(uint32 id, const char *url, int socket)
+  *		A new connection socket was set up for the transfer.
+  *
+  *  tls__done(uint32 id, const char *url, uint64 microseconds)
+  *		TLS handshake complete, the request is about to be sent (time since the start of the transfer).
+  *
+  *  first__byte(uint32 id, const char *url, int status)
+  *		Response status line received.
+  *
+  *  write(uint32 id, uint64 bytes, uint64 offset)
+  *		Response body chunk received.
+  *
+  *  complete(uint32 id, const char *url, int status, uint64 bytes, uint64 microseconds)
+  *		Transfer finished (HTTP status, body length and total time).
+  *
+  *  error(uint32 id, const char *url, int code, const char *message)
+  *		Transfer failed (curl error code and message).
+  *
+  * Example:
+  *
+  *	bpftrace -e 'usdt:/usr/lib64/libudjathttp.so:udjathttp:complete { @[str(arg1)] = hist(arg4); }'
+  *
+  */
+
+ #pragma once
+ #include <config.h>
+
+ #if defined(HAVE_USDT)
+
+	#include <sys/sdt.h>
+	#define HTTP_PROBE(...) STAP_PROBEV(udjathttp,__VA_ARGS__)
+
+ #else
+
+	#define HTTP_PROBE(...) do { } while(0)
+
+ #endif // HAVE_USDT
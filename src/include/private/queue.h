@@ -0,0 +1,132 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Declare bounded delivery queue for asynchronous actions.
+  */
+
+ #pragma once
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <atomic>
+ #include <memory>
+ #include <string>
+ #include <vector>
+ #include <thread>
+ #include <mutex>
+ #include <condition_variable>
+ #include <functional>
+
+ namespace Udjat {
+
+ 	namespace HTTP {
+
+		/// @brief Bounded lock-free (MPMC) queue of rendered payloads, drained by a pool of workers.
+		class UDJAT_PRIVATE Queue {
+		public:
+
+			/// @brief What to do when the queue is full.
+			enum Overflow : uint8_t {
+				DropOldest,		///< @brief Discard the oldest queued payload.
+				DropNewest,		///< @brief Discard the payload being queued.
+				Block,			///< @brief Wait for a free slot.
+			};
+
+			/// @brief Get overflow policy from name.
+			static Overflow OverflowFactory(const char *name);
+
+			/// @brief Queue metrics.
+			struct Metrics {
+				size_t depth = 0;			///< @brief Payloads waiting for delivery.
+				size_t peak = 0;			///< @brief Highest depth seen.
+				uint64_t enqueued = 0;		///< @brief Payloads accepted.
+				uint64_t dropped = 0;		///< @brief Payloads discarded by the overflow policy.
+				uint64_t delivered = 0;		///< @brief Payloads sent with success.
+				uint64_t failed = 0;		///< @brief Payloads sent with error.
+			};
+
+		private:
+
+			struct Cell {
+				std::atomic<size_t> sequence;
+				std::string payload;
+			};
+
+			std::unique_ptr<Cell[]> cells;
+			const size_t mask;
+			const Overflow overflow;
+
+			alignas(64) std::atomic<size_t> head{0};	///< @brief Next enqueue position.
+			alignas(64) std::atomic<size_t> tail{0};	///< @brief Next dequeue position.
+
+			struct {
+				std::atomic<size_t> peak{0};
+				std::atomic<uint64_t> enqueued{0};
+				std::atomic<uint64_t> dropped{0};
+				std::atomic<uint64_t> delivered{0};
+				std::atomic<uint64_t> failed{0};
+			} counters;
+
+			/// @brief Sleeping threads, only used to wait; push() and pop() never take the mutex.
+			struct {
+				std::mutex guard;
+				std::condition_variable cond;
+				std::atomic<unsigned int> waiting{0};
+			} idle;
+
+			std::atomic<bool> enabled{true};
+
+			/// @brief Deliver payload, return true on success.
+			const std::function<bool(const std::string &payload)> deliver;
+
+			std::vector<std::thread> workers;
+
+			bool push(std::string &payload) noexcept;
+			bool pop(std::string &payload) noexcept;
+
+			/// @brief Wake up waiting threads.
+			void wake() noexcept;
+
+			/// @brief Wait for a state change.
+			void wait() noexcept;
+
+		public:
+
+			/// @brief Create queue and start the workers.
+			/// @param capacity Maximum number of queued payloads (rounded up to a power of two).
+			/// @param workers Number of delivery threads.
+			/// @param overflow What to do when the queue is full.
+			/// @param deliver Send payload, return true on success.
+			Queue(size_t capacity, unsigned int workers, Overflow overflow, const std::function<bool(const std::string &payload)> &deliver);
+
+			/// @brief Stop the workers after delivering the queued payloads.
+			~Queue();
+
+			/// @brief Enqueue payload for delivery.
+			/// @return false if the payload was dropped.
+			bool enqueue(std::string &&payload);
+
+			/// @brief Get queue metrics.
+			Metrics metrics() const noexcept;
+
+		};
+
+	}
+
+ }
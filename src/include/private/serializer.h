@@ -0,0 +1,93 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Declare request serializers.
+  */
+
+ #pragma once
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <udjat/agent/abstract.h>
+ #include <string>
+ #include <vector>
+
+ namespace Udjat {
+
+ 	namespace HTTP {
+
+		/// @brief Encode object properties into a request body, one field at a time.
+		class UDJAT_PRIVATE Serializer {
+		public:
+
+			enum Format : uint8_t {
+				Json,		///< @brief JSON object with string members.
+				Form,		///< @brief application/x-www-form-urlencoded.
+				Xml,		///< @brief XML element with one child for each field.
+			};
+
+			/// @brief Get format from the payload-format attribute.
+			static Format FormatFactory(const char *name);
+
+		private:
+			const Format format;
+			const Abstract::Object &object;
+			const std::vector<std::string> &fields;
+
+			/// @brief Next field (0 is the prefix, fields.size()+1 the suffix).
+			size_t field = 0;
+
+			/// @brief Fields written.
+			size_t emitted = 0;
+
+			/// @brief Encoded piece being sent.
+			std::string chunk;
+			size_t offset = 0;
+
+			/// @brief Encode the next piece.
+			/// @return false at the end of the body.
+			bool next();
+
+		public:
+			/// @brief Create serializer.
+			/// @param format The body format.
+			/// @param object The object with the field values, must be valid while reading.
+			/// @param fields The property names, must be valid while reading.
+			Serializer(Format format, const Abstract::Object &object, const std::vector<std::string> &fields);
+
+			/// @brief Get the Content-Type of the format.
+			static const char * mimetype(Format format) noexcept;
+
+			/// @brief Get the Content-Type of the body.
+			inline const char * mimetype() const noexcept {
+				return mimetype(format);
+			}
+
+			/// @brief Write the next bytes of the body.
+			/// @return Number of bytes written, 0 at the end of the body.
+			size_t read(char *buffer, size_t length);
+
+			/// @brief Get the whole body.
+			std::string str();
+
+		};
+
+	}
+
+ }
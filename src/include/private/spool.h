@@ -0,0 +1,136 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Declare persistent spool for failed deliveries.
+  */
+
+ #pragma once
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <atomic>
+ #include <cstdint>
+ #include <ctime>
+ #include <deque>
+ #include <memory>
+ #include <string>
+ #include <thread>
+ #include <mutex>
+ #include <condition_variable>
+ #include <functional>
+
+ namespace Udjat {
+
+ 	namespace HTTP {
+
+		/// @brief Append-only log of memory mapped segments, replayed in order by a background worker.
+		class UDJAT_PRIVATE Spool {
+		public:
+
+			/// @brief Spool limits.
+			struct Limits {
+				size_t segment = 1048576;		///< @brief Segment length.
+				size_t size = 67108864;			///< @brief Maximum disk usage, the oldest segments are dropped above it.
+				time_t retry = 5;				///< @brief Delay after the first failure (in seconds).
+				time_t ceiling = 300;			///< @brief Maximum delay between retries (in seconds).
+			};
+
+			/// @brief Spool metrics.
+			struct Metrics {
+				size_t pending = 0;			///< @brief Requests waiting for replay.
+				size_t bytes = 0;			///< @brief Disk usage.
+				uint64_t spooled = 0;		///< @brief Requests stored.
+				uint64_t replayed = 0;		///< @brief Requests delivered from the spool.
+				uint64_t dropped = 0;		///< @brief Requests lost to the disk limit.
+			};
+
+		private:
+
+			class Segment;
+
+			const std::string path;
+			const Limits limits;
+
+			/// @brief Send payload, return true on success.
+			const std::function<bool(const std::string &payload)> deliver;
+
+			std::mutex guard;
+			std::condition_variable cond;
+			bool enabled = true;
+
+			/// @brief Sequence numbers of the segments on disk, oldest first.
+			std::deque<uint64_t> segments;
+
+			std::shared_ptr<Segment> writer;
+			std::shared_ptr<Segment> reader;
+
+			size_t pending = 0;
+			size_t bytes = 0;
+			uint64_t last = 0;		///< @brief Sequence of the newest segment.
+
+			struct {
+				uint64_t spooled = 0;
+				uint64_t replayed = 0;
+				uint64_t dropped = 0;
+			} counters;
+
+			std::thread worker;
+
+			/// @brief Get segment file name.
+			std::string filename(uint64_t sequence) const;
+
+			/// @brief Rename a damaged segment to '.bad', keeping it for inspection.
+			void quarantine(uint64_t sequence) noexcept;
+
+			/// @brief Open segment, reusing the writer if it is the same.
+			std::shared_ptr<Segment> open(uint64_t sequence);
+
+			/// @brief Remove the oldest segment, counting the requests lost.
+			void drop();
+
+			/// @brief Get the next undelivered request.
+			/// @return false if the spool is empty.
+			bool next(std::string &payload, uint64_t &sequence, size_t &offset);
+
+			/// @brief Mark request as delivered.
+			void commit(uint64_t sequence, size_t offset) noexcept;
+
+		public:
+
+			/// @brief Open spool, replaying the requests left by the previous run.
+			/// @param path The spool directory, created if not available.
+			/// @param limits The spool limits.
+			/// @param deliver Send payload, return true on success.
+			Spool(const char *path, const Limits &limits, const std::function<bool(const std::string &payload)> &deliver);
+			~Spool();
+
+			/// @brief Are there requests waiting for replay?
+			bool empty() noexcept;
+
+			/// @brief Store request for replay.
+			void push(const std::string &payload);
+
+			/// @brief Get spool metrics.
+			Metrics metrics() noexcept;
+
+		};
+
+	}
+
+ }
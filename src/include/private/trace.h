@@ -0,0 +1,81 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Declare binary transfer trace.
+  */
+
+ #pragma once
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <cstdint>
+ #include <cstddef>
+ #include <string>
+ #include <vector>
+
+ namespace Udjat {
+
+ 	namespace HTTP {
+
+		/// @brief Per-thread ring of fixed size transfer events, recorded without locks or allocation.
+		class UDJAT_PRIVATE Trace {
+		public:
+
+			/// @brief Event type, in the order of curl_infotype.
+			enum Type : uint8_t {
+				Text,
+				HeaderIn,
+				HeaderOut,
+				DataIn,
+				DataOut,
+				SslDataIn,
+				SslDataOut,
+			};
+
+			/// @brief Recorded event.
+			struct Event {
+				uint64_t time;			///< @brief Monotonic time in nanoseconds.
+				uint32_t context;		///< @brief Transfer context id.
+				uint32_t thread;		///< @brief Recording thread (sequential id).
+				Type type;
+				uint64_t size;			///< @brief Length of the data or text.
+			};
+
+			/// @brief Get a new context id.
+			static uint32_t id() noexcept;
+
+			/// @brief Record event on the ring of the current thread.
+			static void record(uint32_t context, Type type, size_t size) noexcept;
+
+			/// @brief Get the recorded events of all threads, oldest first.
+			/// @param context The context id, 0 for all.
+			static std::vector<Event> events(uint32_t context = 0);
+
+			/// @brief Get the recorded events as text, one per line.
+			/// @param context The context id, 0 for all.
+			static std::string dump(uint32_t context = 0);
+
+			/// @brief Write the recorded events of a context to the log.
+			static void write(uint32_t context) noexcept;
+
+		};
+
+	}
+
+ }
@@ -27,13 +27,96 @@
  #include <udjat/agent/abstract.h>
  #include <udjat/tools/http/method.h>
  #include <udjat/tools/actions/http.h>
+ #include <udjat/tools/url/handler/http.h>
  #include <udjat/agent.h>
+ #include <memory>
+ #include <vector>
  
  namespace Udjat {
 
 	namespace HTTP {
 
+		class BodyMatcher;
+		class Histogram;
+
 		class UDJAT_API Agent : public Udjat::Agent<int32_t>, private Udjat::URL {		
+		private:
+
+			/// @brief Phase timings of the last probe.
+			HTTP::Timings timings;
+
+			/// @brief State selected when a transfer phase is slower than a threshold.
+			class TimingState;
+			std::vector<std::shared_ptr<TimingState>> slow;
+
+			/// @brief State selected when the server certificate is about to expire.
+			class CertificateState;
+			std::vector<std::shared_ptr<CertificateState>> expiring;
+
+			/// @brief Server certificate monitoring.
+			struct {
+				bool enabled;
+				time_t interval;		///< @brief Minimum time between certificate checks.
+				time_t next = 0;		///< @brief Time of the next certificate check.
+				time_t expires = 0;		///< @brief Earliest expiration on the certificate chain.
+			} certificate;
+
+			/// @brief Get days to the certificate expiration.
+			int expiration() const noexcept;
+
+			/// @brief Refresh scheduling.
+			struct {
+				time_t interval = 0;		///< @brief Base refresh interval (update-timer).
+				time_t jitter = 0;			///< @brief Maximum random delay of the first probe.
+				time_t ceiling = 0;			///< @brief Maximum interval while backing off from failures (0 to disable).
+				time_t recheck = 0;			///< @brief Interval after a state transition (0 to disable).
+				unsigned int failures = 0;	///< @brief Consecutive failed probes.
+			} schedule;
+
+			/// @brief Response body assertions (body-contains, body-matches, json-pointer/json-value).
+			std::shared_ptr<BodyMatcher> matcher;
+
+			/// @brief Agent value when the response body fails the assertions.
+			int32_t mismatch;
+
+			/// @brief Request deadlines from the 'timeout' and 'connect-timeout' attributes (0 to use the defaults).
+			struct {
+				unsigned int total;
+				unsigned int connect;
+			} deadline;
+
+			/// @brief Total probe time over the latency window (latency-window).
+			std::shared_ptr<Histogram> latency;
+
+			/// @brief Handler kept between refreshes, with its connection and prebuilt request.
+			std::shared_ptr<Udjat::URL::Handler> client;
+
+			/// @brief Get cached handler.
+			Udjat::URL::Handler & handler();
+
+			/// @brief Replicated service, from the 'urls' attribute.
+			/// @note Replicas are probed without body assertions or certificate checks (both rejected with 'urls'),
+			/// the phase timings are the ones of the first available replica.
+			struct {
+				std::vector<Udjat::URL> urls;
+				std::vector<std::shared_ptr<Udjat::URL::Handler>> clients;
+				size_t needed = 0;			///< @brief Successful replies required ('policy' and 'quorum' attributes).
+				std::vector<int> values;	///< @brief Status of each replica on the last probe (0 if not needed).
+			} replicas;
+
+			/// @brief Probe the server.
+			/// @return The HTTP status or error code.
+			int probe();
+
+			/// @brief Probe all replicas concurrently.
+			/// @return The HTTP status of the first successful reply if the policy was satisfied, the first error if not.
+			int probe_replicas();
+
+			/// @brief Schedule next refresh.
+			/// @param changed The probe changed the agent state.
+			/// @param failed The probe has failed.
+			void reschedule(bool changed, bool failed);
+
 		public:
 
 			class Factory : public Udjat::Abstract::Agent::Factory {
@@ -50,6 +133,12 @@
 			std::shared_ptr<Abstract::State> computeState() override;
 			bool refresh(bool) override;
 
+			/// @brief Create state, states with 'phase' and 'above' attributes are selected by timing.
+			std::shared_ptr<Abstract::State> StateFactory(const XML::Node &node) override;
+
+			Value & getProperties(Value &value) const override;
+			bool getProperty(const char *key, std::string &value) const override;
+
 		};
 
 	}
@@ -30,6 +30,7 @@
 
  
  #include <memory>
+ #include <string>
 
  namespace Udjat {
 
@@ -44,6 +45,14 @@
 			Module(const char *name);
 			virtual ~Module();
 
+			/// @brief Get module properties, with the transfer metrics of each host on 'hosts'.
+			Value & getProperties(Value &properties) const override;
+
+			/// @brief Get module property.
+			/// @details 'metrics' is the Prometheus text exposition of the transfer metrics,
+			/// 'trace' is the list of transfer events recorded with [http] trace enabled.
+			bool getProperty(const char *key, std::string &value) const override;
+
 		};
 
 	}
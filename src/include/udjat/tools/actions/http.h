@@ -28,17 +28,65 @@
  #include <udjat/tools/url.h>
  #include <udjat/tools/request.h>
  #include <udjat/tools/response.h>
+ #include <memory>
+ #include <string>
+ #include <vector>
  
  namespace Udjat {
 
 	namespace HTTP {
 
+		class Queue;
+		class Batch;
+		class Spool;
+
 		class UDJAT_API Action : public Udjat::Action {
 		protected:
 			const URL url;
 			const HTTP::Method method;
 			const char *payload;
 			const MimeType mimetype;
+
+			/// @brief Request deadlines from the 'timeout' and 'connect-timeout' attributes (0 to use the defaults).
+			struct {
+				unsigned int total;
+				unsigned int connect;
+			} deadline;
+
+			/// @brief Properties sent as the request body ('fields' attribute), empty to use the payload template.
+			std::vector<std::string> fields;
+
+			/// @brief Body format for 'fields' (payload-format attribute: json, form or xml).
+			uint8_t format;
+
+			/// @brief Parse the JSON response while it arrives ('stream-response' and 'response-filter' attributes).
+			struct {
+				bool enabled = false;
+				std::vector<std::string> filter;	///< @brief JSON pointers of the elements to load, empty for all.
+			} stream;
+
+			/// @brief Delivery queue for the asynchronous mode ('async' attribute), empty if synchronous.
+			std::shared_ptr<Queue> queue;
+
+			/// @brief Payload accumulator for the batching mode ('batch' attribute), empty if not batching.
+			std::shared_ptr<Batch> batch;
+
+			/// @brief Persistent store of failed requests ('spool' attribute), empty if disabled.
+			std::shared_ptr<Spool> spool;
+
+			/// @brief Send the request properties, serialized while uploading.
+			int serialize(Udjat::Request &request, Udjat::Response &response);
+
+			/// @brief Send payload from the delivery queue or batch, storing it on the spool if it fails.
+			/// @param payload The request payload.
+			/// @param mimetype The payload type, nullptr to keep the handler default.
+			bool deliver(const std::string &payload, const char *mimetype = nullptr);
+
+			/// @brief Send payload.
+			/// @param payload The request payload.
+			/// @param mimetype The payload type, nullptr to keep the handler default.
+			/// @return true if the receiver has accepted the payload.
+			bool send(const std::string &payload, const char *mimetype = nullptr);
 		
 		public:
 
@@ -53,8 +101,13 @@
 
 			Action(const XML::Node &node);
 
+			virtual ~Action();
+
 			int call(Udjat::Request &request, Udjat::Response &response, bool except) override;
 
+			Value & getProperties(Value &value) const override;
+			bool getProperty(const char *key, std::string &value) const override;
+
 		};
 
 	}
@@ -0,0 +1,89 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Declare per-host transfer metrics.
+  */
+
+ #pragma once
+ #include <udjat/defs.h>
+ #include <cstdint>
+ #include <cstddef>
+ #include <string>
+ #include <vector>
+ #include <map>
+
+ namespace Udjat {
+
+	class Value;
+
+ 	namespace HTTP {
+
+		/// @brief Per-host transfer metrics, counted per thread and merged on read.
+		class UDJAT_API Metrics {
+		public:
+
+			/// @brief Number of latency buckets.
+			static constexpr size_t Buckets = 14;
+
+			/// @brief Upper bounds of the latency buckets in microseconds, the last bucket has no bound.
+			static constexpr uint64_t bounds[Buckets-1] = {
+				1000, 2500, 5000, 10000, 25000, 50000, 100000,
+				250000, 500000, 1000000, 2500000, 5000000, 10000000
+			};
+
+			/// @brief Size of the error table, larger error codes are counted on the last entry.
+			static constexpr size_t Errors = 128;
+
+			/// @brief Totals of one host.
+			struct Host {
+				std::string name;				///< @brief Host name and port, as on the URL.
+				uint64_t requests = 0;
+				uint64_t failed = 0;			///< @brief Transfers finished with error.
+				uint64_t sent = 0;				///< @brief Bytes sent.
+				uint64_t received = 0;			///< @brief Bytes received.
+				uint64_t time = 0;				///< @brief Sum of the request times (in microseconds).
+				uint64_t status[6] = {0};		///< @brief Responses by status class (0 for none, 1 to 5 for 1xx to 5xx).
+				uint64_t latency[Buckets] = {0};
+				std::map<int,uint64_t> errors;	///< @brief Failed transfers by engine error code.
+			};
+
+			/// @brief Count a finished transfer (called by the transfer engine).
+			/// @param host The host name and port.
+			/// @param error The engine error code (0 on success).
+			/// @param status The HTTP status (0 if there was no response).
+			/// @param sent Bytes sent.
+			/// @param received Bytes received.
+			/// @param time Request time in microseconds.
+			static void record(const std::string &host, int error, int status, uint64_t sent, uint64_t received, uint64_t time) noexcept;
+
+			/// @brief Get the totals of every host, merging the per-thread counters.
+			static std::vector<Host> hosts();
+
+			/// @brief Get the totals of every host as an object with one child per host.
+			static Udjat::Value & get(Udjat::Value &value);
+
+			/// @brief Get the totals in the Prometheus text exposition format.
+			static std::string prometheus();
+
+		};
+
+	}
+
+ }
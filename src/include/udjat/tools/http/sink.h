@@ -0,0 +1,182 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Declare output sinks for HTTP responses.
+  */
+
+ #pragma once
+ #include <udjat/defs.h>
+ #include <cstdint>
+ #include <cstddef>
+ #include <string>
+ #include <mutex>
+ #include <condition_variable>
+
+ namespace Udjat {
+
+ 	namespace HTTP {
+
+		/// @brief Output for response data, written directly from the transfer buffers.
+		class UDJAT_API Sink {
+		public:
+			virtual ~Sink();
+
+			/// @brief Response length is known, called before the first write.
+			/// @param total The value of the Content-Length header.
+			virtual void allocate(uint64_t total);
+
+			/// @brief Write a block of response data.
+			/// @param offset Position of the block in the response body.
+			/// @param data The response data.
+			/// @param length Length of the response data.
+			virtual void write(uint64_t offset, const void *data, size_t length) = 0;
+
+			/// @brief Transfer is complete.
+			virtual void finalize();
+
+			/// @brief Transfer has failed, no more data will be written.
+			/// @param error The error code (errno).
+			virtual void abort(int error) noexcept;
+
+		};
+
+		/// @brief Fixed size ring buffer, the response can be read from another thread while downloading.
+		class UDJAT_API RingBufferSink : public Sink {
+		private:
+			std::mutex guard;
+			std::condition_variable cond;
+
+			uint8_t *buffer;
+			const size_t capacity;
+
+			size_t head = 0;		///< @brief Read position.
+			size_t used = 0;		///< @brief Bytes available for reading.
+
+			bool eof = false;		///< @brief The transfer is complete.
+			bool closed = false;	///< @brief The consumer is gone.
+			int error = 0;			///< @brief The transfer has failed.
+
+		public:
+			RingBufferSink(size_t capacity = 65536);
+			virtual ~RingBufferSink();
+
+			/// @brief Write response data, waits while the buffer is full.
+			void write(uint64_t offset, const void *data, size_t length) override;
+
+			void finalize() override;
+			void abort(int error) noexcept override;
+
+			/// @brief Read response data, waits until there is data or the transfer is complete.
+			/// @return Number of bytes read, 0 at the end of the response.
+			/// @exception std::system_error The transfer has failed.
+			size_t read(void *data, size_t length);
+
+			/// @brief Stop consuming, the next write will cancel the transfer.
+			void close();
+
+		};
+
+		/// @brief Unnamed file (O_TMPFILE) receiving the response with positional writes.
+		/// @details Without O_TMPFILE the response goes to a hidden file on the same directory.
+		class UDJAT_API FileSink : public Sink {
+		private:
+			int fd;
+			uint64_t length = 0;
+
+			/// @brief Name of the temporary file, only when the filesystem has no O_TMPFILE.
+			std::string name;
+
+		public:
+			/// @brief Create unnamed file.
+			/// @param dir Directory for the file (should be on the same filesystem as the final name).
+			FileSink(const char *dir = "/tmp");
+			virtual ~FileSink();
+
+			void allocate(uint64_t total) override;
+			void write(uint64_t offset, const void *data, size_t length) override;
+
+			inline int descriptor() const noexcept {
+				return fd;
+			}
+
+			inline uint64_t size() const noexcept {
+				return length;
+			}
+
+			/// @brief Give the file a name, replacing an existing file only on success.
+			/// @param filename The new file name, must be on the same filesystem.
+			void save(const char *filename);
+
+		};
+
+		/// @brief Preallocated memory region.
+		class UDJAT_API MemorySink : public Sink {
+		private:
+			uint8_t *region;
+			const size_t capacity;
+			const bool allocated;
+			size_t length = 0;
+
+		public:
+			/// @brief Use an application provided memory region.
+			MemorySink(void *region, size_t capacity);
+
+			/// @brief Allocate a memory region.
+			MemorySink(size_t capacity);
+
+			virtual ~MemorySink();
+
+			void write(uint64_t offset, const void *data, size_t length) override;
+
+			inline const void * data() const noexcept {
+				return region;
+			}
+
+			inline size_t size() const noexcept {
+				return length;
+			}
+
+		};
+
+		/// @brief Discard the response keeping only its digest.
+		class UDJAT_API HashSink : public Sink {
+		private:
+			void *ctx;
+			std::string value;
+
+		public:
+			/// @brief Create hash sink.
+			/// @param algorithm The digest name ("sha256", "sha1", "md5", ...).
+			HashSink(const char *algorithm = "sha256");
+			virtual ~HashSink();
+
+			void write(uint64_t offset, const void *data, size_t length) override;
+			void finalize() override;
+
+			/// @brief Get the hexadecimal digest (valid after the transfer).
+			inline const char * hex() const noexcept {
+				return value.c_str();
+			}
+
+		};
+
+	}
+
+ }
@@ -25,8 +25,13 @@
  #include <udjat/defs.h>
  #include <udjat/tools/url.h>
  #include <udjat/tools/url/handler.h>
+ #include <udjat/tools/http/sink.h>
  #include <vector>
  #include <string>
+ #include <functional>
+ #include <memory>
+ #include <mutex>
+ #include <ctime>
  
  namespace Udjat {
 
@@ -34,17 +39,47 @@
 
 		class Context;
 
+		/// @brief Transfer phase timings, in microseconds since the start of the request.
+		struct Timings {
+			uint64_t namelookup = 0;	///< @brief Name resolving.
+			uint64_t connect = 0;		///< @brief TCP connect.
+			uint64_t appconnect = 0;	///< @brief TLS handshake.
+			uint64_t pretransfer = 0;	///< @brief Ready to send the request.
+			uint64_t starttransfer = 0;	///< @brief First response byte.
+			uint64_t total = 0;			///< @brief Transfer complete.
+		};
+
+		/// @brief Server certificate, from the TLS handshake.
+		struct Certificate {
+			std::string subject;
+			std::string issuer;
+			time_t expires = 0;		///< @brief Expiration time (0 if unknown).
+		};
+
 		/// @brief The HTTP client engine.
 		class UDJAT_API Handler : public Udjat::URL::Handler {
 		private:
 			friend class Context;
 
-			struct Header {
-				const std::string name;
-				const std::string value;
+			/// @brief Movable HTTP header, well-known names are interned.
+			class Header {
+			private:
+				/// @brief Static name for well-known headers.
+				const char *interned;
+
+				/// @brief Name storage for the other headers.
+				std::string custom;
 
-				Header(const char *n, const char *v) : name{n}, value{v} {
+			public:
+				std::string value;
+
+				Header(const char *name, const char *value);
+				Header(const char *name, size_t namelen, const char *value, size_t valuelen);
+
+				inline const char * name() const noexcept {
+					return interned ? interned : custom.c_str();
 				}
+
 			};
 
 			struct {
@@ -52,6 +87,56 @@
 				std::vector<Header> response;
 			} headers;
 
+			/// @brief Progress notification channel, throttled by time and byte deltas.
+			struct {
+				std::function<bool(uint64_t current, uint64_t total)> callback;
+				unsigned int interval = 0;	///< @brief Minimum interval between notifications (in milliseconds).
+				uint64_t step = 0;			///< @brief Minimum byte delta between notifications.
+			} notify;
+
+			/// @brief Request body producer, replaces the payload when set.
+			std::function<size_t(char *buffer, size_t length)> upload;
+
+			/// @brief Size of the write coalescing buffer (0 to disable).
+			size_t buffersize;
+
+			/// @brief Digest computed while downloading.
+			struct Digest {
+				std::string algorithm;	///< @brief Digest name ("sha256", "md5", ...).
+				std::string expected;	///< @brief Expected value (hex or base64), empty to use the response headers.
+				std::string value;		///< @brief Computed value (hex) of the last transfer.
+			};
+
+			std::vector<Digest> digests;
+
+			/// @brief Timings of the last transfer.
+			HTTP::Timings timings;
+
+			/// @brief Certificate chain capture.
+			struct {
+				bool enabled = false;
+				std::vector<HTTP::Certificate> chain;
+			} certinfo;
+
+			/// @brief Request deadlines (in seconds, 0 to disable).
+			struct {
+				unsigned int connect;		///< @brief Connection establishment.
+				unsigned int total;			///< @brief Whole transfer.
+				struct {
+					unsigned int limit;		///< @brief Minimum transfer rate (bytes per second).
+					unsigned int time;		///< @brief Abort after the rate stays below the limit for this time.
+				} lowspeed;
+			} deadline;
+
+			/// @brief Transfer state kept between requests (curl handle, open connection, header list).
+			struct {
+				std::mutex guard;
+				std::unique_ptr<Context> context;
+			} cache;
+
+			/// @brief Run a transfer on the cached context, or on a new one if it is busy.
+			int transfer(const std::function<int(Context &context)> &call);
+
 		protected:
 			const URL url;
 
@@ -72,14 +157,103 @@
 
 			bool get(Udjat::Value &value, const HTTP::Method method = HTTP::Get, const char *payload = "") override;
 
+			/// @brief Parse the JSON response while it arrives, without buffering the body.
+			/// @param value The value to populate.
+			/// @param filter JSON pointers of the elements to load, empty to load all.
+			bool get(Udjat::Value &value, const HTTP::Method method, const char *payload, const std::vector<std::string> &filter);
+
 			URL::Handler & header(const char *name, const char *value) override;
 
 			const char * header(const char *name) const override;
 
+			/// @brief Set progress notifier, called apart from the data writer at a limited rate.
+			/// @param callback The progress notifier with the received and expected bytes of the response body, return true to cancel the transfer.
+			/// @param interval Minimum interval between notifications in milliseconds (0 to use [http] progress-interval).
+			/// @param step Minimum byte delta between notifications (0 to use [http] progress-step).
+			/// @note Request bodies (uploads) are not reported.
+			HTTP::Handler & progress(const std::function<bool(uint64_t current, uint64_t total)> &callback, unsigned int interval = 0, uint64_t step = 0);
+
+			/// @brief Write the request body from a producer instead of the payload string.
+			/// @param producer Write up to 'length' bytes on buffer, return the number of bytes written (0 at the end of the body).
+			inline HTTP::Handler & body(const std::function<size_t(char *buffer, size_t length)> &producer) {
+				upload = producer;
+				return *this;
+			}
+
+			/// @brief Batch small chunks into blocks of up to 'size' bytes before calling the writer.
+			/// @param size The coalescing buffer size (0 to deliver every chunk as received).
+			inline HTTP::Handler & buffer(size_t size) noexcept {
+				buffersize = size;
+				return *this;
+			}
+
+			/// @brief Compute a digest while downloading and verify it before completing the transfer.
+			/// @param algorithm The digest name ("sha256", "sha-512", "md5", ...).
+			/// @param expected The expected value in hex or base64, empty to get it from the Digest, Repr-Digest or Content-MD5 headers.
+			HTTP::Handler & verify(const char *algorithm, const char *expected = "");
+
+			/// @brief Get digest computed on the last transfer.
+			/// @param algorithm The digest name, as used on verify().
+			/// @return The digest in hex, empty if not available.
+			const char * digest(const char *algorithm) const noexcept;
+
+			/// @brief Get phase timings of the last transfer.
+			inline const HTTP::Timings & timing() const noexcept {
+				return timings;
+			}
+
+			/// @brief Set request deadlines.
+			/// @param total Maximum time for the whole transfer in seconds (0 to keep [curl] timeout).
+			/// @param connect Maximum time to connect in seconds (0 to keep [curl] connect-timeout).
+			inline HTTP::Handler & timeout(unsigned int total, unsigned int connect = 0) noexcept {
+				if(total) {
+					deadline.total = total;
+				}
+				if(connect) {
+					deadline.connect = connect;
+				}
+				return *this;
+			}
+
+			/// @brief Abort transfers slower than 'limit' bytes per second for 'time' seconds.
+			/// @param limit Minimum transfer rate in bytes per second (0 to disable).
+			/// @param time Time the rate can stay below the limit (in seconds).
+			inline HTTP::Handler & lowspeed(unsigned int limit, unsigned int time) noexcept {
+				deadline.lowspeed.limit = limit;
+				deadline.lowspeed.time = time;
+				return *this;
+			}
+
+			/// @brief Enable or disable capture of the server certificate chain.
+			inline HTTP::Handler & certificates(bool enable) noexcept {
+				certinfo.enabled = enable;
+				return *this;
+			}
+
+			/// @brief Get the certificate chain of the last TLS handshake with capture enabled.
+			inline const std::vector<HTTP::Certificate> & certificates() const noexcept {
+				return certinfo.chain;
+			}
+
 			int test(const HTTP::Method method = HTTP::Get, const char *payload = "") override;
 
+			/// @brief Test URL sending the response body to a writer.
+			/// @param writer The response writer, return true to stop the transfer (the HTTP status is still returned).
+			/// @return The HTTP status or error code.
+			int test(const HTTP::Method method, const char *payload, const std::function<bool(uint64_t current, uint64_t total, const void *data, size_t len)> &writer);
+
+			/// @brief Test several URLs concurrently.
+			/// @param handlers The handlers to test.
+			/// @param needed Stop after this number of successful (2xx or 3xx) responses, 0 to wait for all.
+			/// @return The HTTP status or error code of each handler, 0 for the ones stopped before completion.
+			static std::vector<int> test(const std::vector<HTTP::Handler *> &handlers, size_t needed = 0, const HTTP::Method method = HTTP::Get, const char *payload = "");
+
 			int perform(const HTTP::Method method, const char *payload, const std::function<bool(uint64_t current, uint64_t total, const void *data, size_t len)> &progress) override;
 
+			/// @brief Perform request writing the response directly into a sink.
+			/// @param sink The response output.
+			int perform(const HTTP::Method method, const char *payload, HTTP::Sink &sink);
+
 		};
 
  	}
@@ -27,7 +27,16 @@
  #include <udjat/tools/actions/abstract.h>
  #include <udjat/tools/actions/http.h>
  #include <udjat/tools/url.h>
+ #include <udjat/tools/url/handler/http.h>
+ #include <udjat/tools/configuration.h>
+ #include <udjat/tools/logger.h>
+ #include <private/queue.h>
+ #include <private/batch.h>
+ #include <private/spool.h>
+ #include <private/serializer.h>
  #include <memory>
+ #include <system_error>
+ #include <errno.h>
 
  using namespace std;
  
@@ -40,24 +49,384 @@
 	HTTP::Action::Action(const XML::Node &node) 
 		: 	Udjat::Action{node}, 
 			url{node,"url",true},
-			method{HTTP::MethodFactory(node,"get")},
+			method{HTTP::MethodFactory(node,(node.attribute("batch") ? "post" : "get"))},
 			payload{super::payload(node)}, 
 			mimetype{MimeTypeFactory(String{node,"payload-format","json"}.c_str())} {
+
+		deadline.total = node.attribute("timeout").as_uint(0);
+		deadline.connect = node.attribute("connect-timeout").as_uint(0);
+
+		{
+			// JSON pointers, separated by spaces or commas.
+			std::string filter{node.attribute("response-filter").as_string()};
+			for(size_t from = filter.find_first_not_of(", \t\r\n"); from != std::string::npos; from = filter.find_first_not_of(", \t\r\n",from)) {
+				size_t to = filter.find_first_of(", \t\r\n",from);
+				stream.filter.push_back(filter.substr(from,to == std::string::npos ? std::string::npos : to-from));
+				from = to;
+			}
+			stream.enabled = node.attribute("stream-response").as_bool(!stream.filter.empty());
+		}
+
+		{
+			// Request properties, separated by spaces or commas.
+			std::string names{node.attribute("fields").as_string()};
+			for(size_t from = names.find_first_not_of(", \t\r\n"); from != std::string::npos; from = names.find_first_not_of(", \t\r\n",from)) {
+				size_t to = names.find_first_of(", \t\r\n",from);
+				fields.push_back(names.substr(from,to == std::string::npos ? std::string::npos : to-from));
+				from = to;
+			}
+			format = (fields.empty() ? Serializer::Json : Serializer::FormatFactory(String{node,"payload-format","json"}.c_str()));
+		}
+
+		if(node.attribute("async").as_bool(false)) {
+
+			// The batches already leave from their own thread, a queue in front of them would never be used.
+			if(node.attribute("batch")) {
+				throw system_error(EINVAL,system_category(),"Asynchronous delivery can't be combined with batches");
+			}
+
+			queue = make_shared<Queue>(
+				node.attribute("queue-size").as_uint(Config::Value<unsigned int>("http","async-queue-size",1024).get()),
+				node.attribute("workers").as_uint(Config::Value<unsigned int>("http","async-workers",1).get()),
+				Queue::OverflowFactory(node.attribute("overflow").as_string(Config::Value<string>("http","async-overflow","drop-oldest").c_str())),
+				[this](const std::string &payload) {
+					return deliver(payload);
+				}
+			);
+		}
+
+		if(node.attribute("batch")) {
+
+			// The batch is the request body, only POST sends it (GET and the custom verbs would send it empty).
+			if(method != HTTP::Post) {
+				throw system_error(EINVAL,system_category(),"Batched delivery requires the 'post' method");
+			}
+
+			Batch::Limits limits;
+			limits.items = node.attribute("batch-size").as_uint(Config::Value<unsigned int>("http","batch-size",100).get());
+			limits.bytes = node.attribute("batch-bytes").as_uint(Config::Value<unsigned int>("http","batch-bytes",1048576).get());
+			limits.interval = node.attribute("batch-interval").as_uint(Config::Value<unsigned int>("http","batch-interval",1000).get());
+
+			batch = make_shared<Batch>(
+				Batch::FramingFactory(node.attribute("batch").as_string()),
+				limits,
+				[this](const std::string &body, const char *mimetype) {
+					return deliver(body,mimetype);
+				}
+			);
+
+		}
+
+		if(node.attribute("spool")) {
+
+			Spool::Limits limits;
+			limits.segment = node.attribute("spool-segment").as_uint(Config::Value<unsigned int>("http","spool-segment",1048576).get());
+			limits.size = node.attribute("spool-size").as_ullong(Config::Value<unsigned int>("http","spool-size",67108864).get());
+			limits.retry = node.attribute("retry-interval").as_uint(Config::Value<unsigned int>("http","spool-retry",5).get());
+			limits.ceiling = node.attribute("retry-limit").as_uint(Config::Value<unsigned int>("http","spool-retry-limit",300).get());
+
+			const char *mimetype = (batch ? batch->mimetype() : nullptr);
+
+			spool = make_shared<Spool>(
+				node.attribute("spool").as_string(),
+				limits,
+				[this,mimetype](const std::string &payload) {
+					return send(payload,mimetype);
+				}
+			);
+
+		}
+
+	}
+
+	HTTP::Action::~Action() {
+		// Deliver the pending payloads while the action is still valid, the failures go to the spool.
+		batch.reset();
+		queue.reset();
+		spool.reset();
+	}
+
+	int HTTP::Action::serialize(Udjat::Request &request, Udjat::Response &response) {
+
+		Serializer serializer{(Serializer::Format) format,request,fields};
+
+		auto handler = url.handler();
+
+		auto http = dynamic_cast<HTTP::Handler *>(handler.get());
+		if(!http) {
+			// Not an HTTP handler, send it as a payload.
+			return handler->get(response,method,serializer.str().c_str()) ? 0 : -1;
+		}
+
+		http->timeout(deadline.total,deadline.connect);
+		http->header("Content-Type",serializer.mimetype());
+		http->body([&serializer](char *buffer, size_t length){
+			return serializer.read(buffer,length);
+		});
+
+		bool success = (stream.enabled ? http->get(response,method,"",stream.filter) : http->get(response,method,""));
+
+		http->body(nullptr);
+
+		return success ? 0 : -1;
+
+	}
+
+	bool HTTP::Action::deliver(const std::string &payload, const char *mimetype) {
+
+		if(spool && !spool->empty()) {
+			// Keep the order, the spool is delivered first.
+			spool->push(payload);
+			return true;
+		}
+
+		if(send(payload,mimetype)) {
+			return true;
+		}
+
+		if(spool) {
+			spool->push(payload);
+		}
+
+		return false;
+
+	}
+
+	bool HTTP::Action::send(const std::string &payload, const char *mimetype) {
+
+		auto handler = url.handler();
+
+		auto http = dynamic_cast<HTTP::Handler *>(handler.get());
+		if(http) {
+			http->timeout(deadline.total,deadline.connect);
+		}
+
+		if(!mimetype && !fields.empty()) {
+			mimetype = Serializer::mimetype((Serializer::Format) format);
+		}
+
+		if(mimetype) {
+			handler->header("Content-Type",mimetype);
+		}
+
+		int rc = handler->test(method,payload.c_str());
+		if(rc < 200 || rc > 299) {
+			Logger::String{"Request to ",url.c_str()," has failed: ",(handler->status.message.empty() ? std::to_string(rc) : handler->status.message)}.error(name());
+			return false;
+		}
+
+		return true;
+
 	}
 
 	int HTTP::Action::call(Udjat::Request &request, Udjat::Response &response, bool except) {
 		return Udjat::Action::exec(response,except,[&]() {
 
-			String payload{this->payload};
-			payload.expand(request);
+			if(!fields.empty() && !(batch || queue || spool)) {
+				return serialize(request,response);
+			}
 
-			if(!url.get(response,method,payload.c_str())) {
-				return -1;
+			String payload;
+			if(fields.empty()) {
+				payload = this->payload;
+				payload.expand(request);
+			} else {
+				// Serialized now, the request is not valid after the call.
+				payload = Serializer{(Serializer::Format) format,request,fields}.str();
 			}
 
+			if(batch) {
+				// Sent with the other payloads when the batch is flushed.
+				batch->push(payload);
+				return 0;
+			}
+
+			if(queue) {
+				// Fire and forget, the request is sent from the queue workers.
+				if(!queue->enqueue(std::move(payload))) {
+					// Dropped by the overflow policy.
+					errno = ENOSPC;
+					return -1;
+				}
+				return 0;
+			}
+
+			if(spool && !spool->empty()) {
+				// Keep the order, the spool is delivered first.
+				spool->push(payload);
+				return 0;
+			}
+
+			try {
+
+				auto handler = url.handler();
+
+				auto http = dynamic_cast<HTTP::Handler *>(handler.get());
+				if(http) {
+					http->timeout(deadline.total,deadline.connect);
+				}
+
+				if(http && stream.enabled) {
+					if(http->get(response,method,payload.c_str(),stream.filter)) {
+						return 0;
+					}
+				} else if(handler->get(response,method,payload.c_str())) {
+					return 0;
+				}
+
+				if(!spool) {
+					return -1;
+				}
+
+			} catch(const std::exception &e) {
+
+				if(!spool) {
+					throw;
+				}
+
+				Logger::String{e.what()}.warning(name());
+
+			}
+
+			// Failed, replay later.
+			spool->push(payload);
 			return 0;
 
 		});
 	}
 
- }
\ No newline at end of file
+	Value & HTTP::Action::getProperties(Value &value) const {
+
+		Udjat::Action::getProperties(value);
+
+		if(queue) {
+			auto metrics = queue->metrics();
+			value["queue-depth"] = (unsigned int) metrics.depth;
+			value["queue-peak"] = (unsigned int) metrics.peak;
+			value["queue-enqueued"] = (unsigned int) metrics.enqueued;
+			value["queue-dropped"] = (unsigned int) metrics.dropped;
+			value["queue-delivered"] = (unsigned int) metrics.delivered;
+			value["queue-failed"] = (unsigned int) metrics.failed;
+		}
+
+		if(batch) {
+			auto metrics = batch->metrics();
+			value["batch-pending"] = (unsigned int) metrics.pending;
+			value["batch-flushes"] = (unsigned int) metrics.flushes;
+			value["batch-items"] = (unsigned int) metrics.items;
+			value["batch-failed"] = (unsigned int) metrics.failed;
+			if(metrics.latency.count) {
+				value["batch-latency-p50"] = ((double) metrics.latency.p50) / 1000.0;
+				value["batch-latency-p99"] = ((double) metrics.latency.p99) / 1000.0;
+				value["batch-latency-max"] = ((double) metrics.latency.max) / 1000.0;
+			}
+		}
+
+		if(spool) {
+			auto metrics = spool->metrics();
+			value["spool-pending"] = (unsigned int) metrics.pending;
+			value["spool-bytes"] = (unsigned int) metrics.bytes;
+			value["spool-stored"] = (unsigned int) metrics.spooled;
+			value["spool-replayed"] = (unsigned int) metrics.replayed;
+			value["spool-dropped"] = (unsigned int) metrics.dropped;
+		}
+
+		return value;
+
+	}
+
+	bool HTTP::Action::getProperty(const char *key, std::string &value) const {
+
+		if(queue && strncasecmp(key,"queue-",6) == 0) {
+
+			auto metrics = queue->metrics();
+
+			const struct {
+				const char *name;
+				uint64_t value;
+			} properties[] = {
+				{ "queue-depth",		metrics.depth		},
+				{ "queue-peak",			metrics.peak		},
+				{ "queue-enqueued",		metrics.enqueued	},
+				{ "queue-dropped",		metrics.dropped		},
+				{ "queue-delivered",	metrics.delivered	},
+				{ "queue-failed",		metrics.failed		},
+			};
+
+			for(const auto &property : properties) {
+				if(strcasecmp(key,property.name) == 0) {
+					value = std::to_string(property.value);
+					return true;
+				}
+			}
+
+		}
+
+		if(batch && strncasecmp(key,"batch-",6) == 0) {
+
+			auto metrics = batch->metrics();
+
+			const struct {
+				const char *name;
+				uint64_t value;
+			} properties[] = {
+				{ "batch-pending",	metrics.pending		},
+				{ "batch-flushes",	metrics.flushes		},
+				{ "batch-items",	metrics.items		},
+				{ "batch-failed",	metrics.failed		},
+			};
+
+			for(const auto &property : properties) {
+				if(strcasecmp(key,property.name) == 0) {
+					value = std::to_string(property.value);
+					return true;
+				}
+			}
+
+			const struct {
+				const char *name;
+				uint64_t value;
+			} latencies[] = {
+				{ "batch-latency-p50",	metrics.latency.p50	},
+				{ "batch-latency-p99",	metrics.latency.p99	},
+				{ "batch-latency-max",	metrics.latency.max	},
+			};
+
+			for(const auto &latency : latencies) {
+				if(strcasecmp(key,latency.name) == 0) {
+					value = std::to_string(((double) latency.value) / 1000.0);
+					return true;
+				}
+			}
+
+		}
+
+		if(spool && strncasecmp(key,"spool-",6) == 0) {
+
+			auto metrics = spool->metrics();
+
+			const struct {
+				const char *name;
+				uint64_t value;
+			} properties[] = {
+				{ "spool-pending",	metrics.pending		},
+				{ "spool-bytes",	metrics.bytes		},
+				{ "spool-stored",	metrics.spooled		},
+				{ "spool-replayed",	metrics.replayed	},
+				{ "spool-dropped",	metrics.dropped		},
+			};
+
+			for(const auto &property : properties) {
+				if(strcasecmp(key,property.name) == 0) {
+					value = std::to_string(property.value);
+					return true;
+				}
+			}
+
+		}
+
+		return Udjat::Action::getProperty(key,value);
+
+	}
+
+ }
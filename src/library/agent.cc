@@ -30,48 +30,428 @@
  #include <udjat/agent/http.h>
  #include <udjat/tools/url.h>
  #include <udjat/tools/url/handler.h>
+ #include <udjat/tools/url/handler/http.h>
+ #include <udjat/tools/string.h>
+ #include <udjat/tools/configuration.h>
+ #include <udjat/tools/logger.h>
+ #include <private/matcher.h>
+ #include <private/histogram.h>
  #include <memory>
+ #include <stdexcept>
+ #include <system_error>
+ #include <errno.h>
+ #include <algorithm>
+ #include <random>
+ #include <ctime>
 
  using namespace std;
  
  namespace Udjat {
 
+	/// @brief Transfer phases, as exposed on agent properties (in milliseconds).
+	static const struct {
+		const char *name;
+		uint64_t HTTP::Timings::*field;
+	} phases[] = {
+		{ "namelookup",		&HTTP::Timings::namelookup		},
+		{ "connect",		&HTTP::Timings::connect			},
+		{ "appconnect",		&HTTP::Timings::appconnect		},
+		{ "pretransfer",	&HTTP::Timings::pretransfer		},
+		{ "starttransfer",	&HTTP::Timings::starttransfer	},
+		{ "ttfb",			&HTTP::Timings::starttransfer	},
+		{ "total",			&HTTP::Timings::total			},
+	};
+
+	/// @brief Latency percentiles over the window (in milliseconds).
+	static const struct {
+		const char *name;
+		uint64_t HTTP::Histogram::Summary::*field;
+	} percentiles[] = {
+		{ "latency-p50",	&HTTP::Histogram::Summary::p50	},
+		{ "latency-p90",	&HTTP::Histogram::Summary::p90	},
+		{ "latency-p99",	&HTTP::Histogram::Summary::p99	},
+		{ "latency-max",	&HTTP::Histogram::Summary::max	},
+	};
+
+	class UDJAT_PRIVATE HTTP::Agent::TimingState : public Abstract::State {
+	private:
+		uint64_t HTTP::Timings::*field = nullptr;
+		uint64_t limit;
+
+	public:
+		TimingState(const XML::Node &node) : Abstract::State{node}, limit{((uint64_t) node.attribute("above").as_uint(0)) * 1000} {
+
+			const char *phase = node.attribute("phase").as_string("ttfb");
+			for(const auto &entry : phases) {
+				if(strcasecmp(entry.name,phase) == 0) {
+					field = entry.field;
+					break;
+				}
+			}
+
+			if(!field) {
+				throw runtime_error(String{"Unexpected transfer phase '",phase,"'"});
+			}
+
+		}
+
+		/// @brief Check if the phase took longer than the limit.
+		inline bool slower(const HTTP::Timings &timings) const noexcept {
+			return limit && (timings.*field) > limit;
+		}
+
+	};
+
+	class UDJAT_PRIVATE HTTP::Agent::CertificateState : public Abstract::State {
+	public:
+		/// @brief Days before expiration to select this state.
+		const int days;
+
+		CertificateState(const XML::Node &node) : Abstract::State{node}, days{node.attribute("expires-within").as_int(0)} {
+		}
+
+	};
+
 	std::shared_ptr<Abstract::Agent> HTTP::Agent::Factory::AgentFactory(const Abstract::Agent &, const XML::Node &node) const {
 		return make_shared<HTTP::Agent>(node);
 	}
 
 	HTTP::Agent::Agent(const XML::Node &node) 
-		: 	Udjat::Agent<int32_t>{node,200}, Udjat::URL{node,"url"} {
+		: 	Udjat::Agent<int32_t>{node,200}, Udjat::URL{node,"url",!node.attribute("urls")} {
+
+		{
+			// Replicas, separated by spaces or commas.
+			std::string urls{node.attribute("urls").as_string()};
+			for(size_t from = urls.find_first_not_of(", \t\r\n"); from != std::string::npos; from = urls.find_first_not_of(", \t\r\n",from)) {
+				size_t to = urls.find_first_of(", \t\r\n",from);
+				replicas.urls.emplace_back(urls.substr(from,to == std::string::npos ? std::string::npos : to-from).c_str());
+				from = to;
+			}
+
+			String policy{node.attribute("policy").as_string("first")};
+			if(strcasecmp(policy.c_str(),"all") == 0) {
+				replicas.needed = replicas.urls.size();
+			} else if(strcasecmp(policy.c_str(),"quorum") == 0) {
+				replicas.needed = node.attribute("quorum").as_uint((replicas.urls.size()/2)+1);
+			} else if(strcasecmp(policy.c_str(),"first") == 0) {
+				replicas.needed = 1;
+			} else {
+				throw std::system_error(EINVAL,std::system_category(),Logger::String{"Unexpected policy '",policy.c_str(),"'"});
+			}
+
+			if(replicas.needed > replicas.urls.size()) {
+				replicas.needed = replicas.urls.size();
+			}
+		}
+
+		schedule.interval = update.timer;
+		schedule.jitter = node.attribute("start-jitter").as_uint(Config::Value<unsigned int>("http","start-jitter",0).get());
+		schedule.ceiling = node.attribute("backoff-limit").as_uint(Config::Value<unsigned int>("http","backoff-limit",0).get());
+		schedule.recheck = node.attribute("recheck-interval").as_uint(0);
+
+		mismatch = node.attribute("body-mismatch-code").as_int(417);
+		matcher = make_shared<BodyMatcher>(node);
+		if(!*matcher) {
+			matcher.reset();
+		}
+
+		certificate.enabled = node.attribute("check-certificate").as_bool(false);
+
+		if(!replicas.urls.empty() && (matcher || certificate.enabled)) {
+			// The replicas are probed with 'test', without body or certificates.
+			throw std::system_error(EINVAL,std::system_category(),"Body assertions and certificate checks are not available with 'urls'");
+		}
+
+		certificate.interval = node.attribute("certificate-check-interval").as_uint(
+									Config::Value<unsigned int>("http","certificate-check-interval",3600).get()
+								);
+
+		deadline.total = node.attribute("timeout").as_uint(0);
+		deadline.connect = node.attribute("connect-timeout").as_uint(0);
+
+		latency = make_shared<Histogram>(
+						node.attribute("latency-window").as_uint(
+							Config::Value<unsigned int>("http","latency-window",3600).get()
+						)
+					);
+
+	}
+
+	int HTTP::Agent::expiration() const noexcept {
+		return (int) ((certificate.expires - time(0)) / 86400);
+	}
+
+	int HTTP::Agent::probe_replicas() {
+
+		std::vector<HTTP::Handler *> http;
+		auto &handlers = replicas.clients;
+
+		replicas.values.assign(replicas.urls.size(),0);
+
+		handlers.resize(replicas.urls.size());
+		for(size_t ix = 0; ix < handlers.size(); ix++) {
+			if(!handlers[ix]) {
+				handlers[ix] = replicas.urls[ix].handler();
+			}
+		}
+
+		for(auto &handler : handlers) {
+			auto h = dynamic_cast<HTTP::Handler *>(handler.get());
+			if(h) {
+				h->timeout(deadline.total,deadline.connect);
+				http.push_back(h);
+			}
+		}
+
+		std::vector<int> results;
+		if(http.size() == handlers.size()) {
+			results = HTTP::Handler::test(http,replicas.needed);
+		} else {
+			// Not all replicas are on http engine, test one by one.
+			for(auto &handler : handlers) {
+				results.push_back(handler->test());
+			}
+		}
+
+		int success = 0;
+		int failure = 0;
+		size_t succeeded = 0;
+		for(size_t ix = 0; ix < results.size(); ix++) {
+
+			replicas.values[ix] = results[ix];
+
+			if(results[ix] && http.size() == handlers.size()) {
+				// Every probe, as on the single url path; replicas not needed for the policy were not probed.
+				uint64_t total = http[ix]->timing().total;
+				if(total) {
+					latency->record(total);
+				}
+			}
+
+			if(results[ix] >= 200 && results[ix] <= 399) {
+				if(!success) {
+					success = results[ix];
+					if(http.size() == handlers.size()) {
+						timings = http[ix]->timing();
+					}
+				}
+				succeeded++;
+			} else if(results[ix] && !failure) {
+				failure = results[ix];
+			}
+
+			if(results[ix] && results[ix] < 100) {
+				// Transport failure, get a new handler on the next refresh.
+				handlers[ix].reset();
+			}
+
+		}
+
+		if(succeeded >= replicas.needed && success) {
+			return success;
+		}
+
+		Logger::String{succeeded," of ",replicas.urls.size()," replica(s) available, ",replicas.needed," required"}.trace(Abstract::Agent::name());
+		return failure ? failure : -ENODATA;
+
+	}
+
+	Udjat::URL::Handler & HTTP::Agent::handler() {
+
+		if(!client) {
+			// Factory lookup only on the first refresh, or after a transport failure.
+			client = Udjat::URL::handler();
+			auto http = dynamic_cast<HTTP::Handler *>(client.get());
+			if(http) {
+				http->timeout(deadline.total,deadline.connect);
+			}
+		}
+
+		return *client;
+
+	}
+
+	int HTTP::Agent::probe() {
+
+		if(!replicas.urls.empty()) {
+			return probe_replicas();
+		}
+
+		auto handler = &this->handler();
+		auto http = dynamic_cast<HTTP::Handler *>(handler);
+
+		// The certificate chain is captured only when the last one is too old.
+		bool certcheck = (http && (certificate.enabled || !expiring.empty()) && time(0) >= certificate.next);
+		if(http) {
+			http->certificates(certcheck);
+		}
+
+		debug("----> Refreshing agent ",Abstract::Agent::name());
+
+		int rc;
+
+		if(matcher && http) {
+
+			// Check the body while it arrives, stopping as soon as the result is known.
+			matcher->reset();
+			rc = http->test(HTTP::Get,"",[this](uint64_t, uint64_t, const void *data, size_t length){
+				return data && length && matcher->write(data,length);
+			});
+
+			if(rc >= 200 && rc <= 299 && !matcher->finish()) {
+				Logger::String{"Response body from ",http->c_str()," does not match the expected content"}.trace(Abstract::Agent::name());
+				rc = mismatch;
+			}
+
+		} else {
+
+			rc = handler->test();
+
+		}
+
+		if(http) {
+
+			timings = http->timing();
+			if(timings.total) {
+				latency->record(timings.total);
+			}
+
+			if(certcheck && !http->certificates().empty()) {
+
+				certificate.next = time(0) + certificate.interval;
+				certificate.expires = 0;
+				for(const auto &cert : http->certificates()) {
+					if(cert.expires && (!certificate.expires || cert.expires < certificate.expires)) {
+						certificate.expires = cert.expires;
+					}
+				}
+
+				if(certificate.expires) {
+					Logger::String{"Server certificate expires in ",expiration()," day(s)"}.trace(Abstract::Agent::name());
+				}
+
+			}
+
+		}
+
+		if(rc < 100) {
+			// Transport failure, get a new handler on the next refresh.
+			client.reset();
+		}
+
+		return rc;
+
+	}
+
+	void HTTP::Agent::reschedule(bool changed, bool failed) {
+
+		if(failed) {
+			schedule.failures++;
+		} else {
+			schedule.failures = 0;
+		}
+
+		if(!schedule.interval || !(schedule.recheck || schedule.ceiling)) {
+			// Fixed update-timer.
+			return;
+		}
+
+		time_t seconds = schedule.interval;
+
+		if(changed && schedule.recheck) {
+
+			// Confirm the new state sooner.
+			seconds = schedule.recheck;
+
+		} else if(schedule.failures > 1 && schedule.ceiling > schedule.interval) {
+
+			// Exponential backoff, don't hammer a failing server.
+			unsigned int shift = std::min(schedule.failures - 1, 16U);
+			seconds = std::min(schedule.interval << shift, schedule.ceiling);
+
+		}
+
+		debug("Next refresh of ",Abstract::Agent::name()," in ",seconds," second(s)");
+		sched_update(seconds);
+
 	}
 
 	bool HTTP::Agent::refresh(bool) {
 
+		if(schedule.jitter) {
+			// Spread the first probe of the agents sharing the same update-timer.
+			static thread_local std::minstd_rand generator{std::random_device{}()};
+			time_t seconds = std::uniform_int_distribution<time_t>{1,schedule.jitter}(generator);
+			schedule.jitter = 0;
+			debug("First refresh of ",Abstract::Agent::name()," delayed by ",seconds," second(s)");
+			sched_update(seconds);
+			return false;
+		}
+
+		int rc;
+
 		try {
 
-			auto handler = Udjat::URL::handler();
+			rc = probe();
 
-			// TODO: setup handler to watch certificates.
-			// https://curl.se/libcurl/c/CURLOPT_CERTINFO.html
+		} catch(const HTTP::Exception &e) {
 
-			debug("----> Refreshing agent ",Abstract::Agent::name());
-			int rc = handler->test();
+			rc = e.code();
 
-			return Udjat::Agent<int32_t>::set(rc);
+		} catch(const std::system_error &e) {
 
-		} catch(const HTTP::Exception &e) {
+			// From the probe, matcher or context; still a failed probe, reschedule and back off.
+			Logger::String{e.what()}.warning(Abstract::Agent::name());
+			rc = -(e.code().value() ? e.code().value() : EIO);
 
-			debug("Unexpected exception");
-			return Udjat::Agent<int32_t>::set(e.code());
+		} catch(const std::exception &e) {
+
+			Logger::String{e.what()}.warning(Abstract::Agent::name());
+			rc = -EIO;
 
 		}
-		
+
+		bool changed = Udjat::Agent<int32_t>::set(rc);
+
+		if(!changed && (!slow.empty() || !expiring.empty())) {
+			// Same status, but the timings or certificate can select another state.
+			auto state = computeState();
+			if(state != Abstract::Agent::state()) {
+				Abstract::Agent::set(state);
+				changed = true;
+			}
+		}
+
+		reschedule(changed, rc < 200 || rc > 399);
+
+		return changed;
+
 	}
 		
 	std::shared_ptr<Abstract::State> HTTP::Agent::computeState() {
 
-		// TODO: Check certificate expiration states.
-
 		unsigned int value = Udjat::Agent<int32_t>::get();
+
+		if(value >= 200 && value < 400) {
+
+			// Only on success, an expiration warning can't hide a server or transport failure.
+			if(certificate.expires) {
+				// Sorted by days, the first one is the most urgent.
+				int days = expiration();
+				for(auto state : expiring) {
+					if(days <= state->days) {
+						return state;
+					}
+				}
+			}
+
+			for(auto state : slow) {
+				if(state->slower(timings)) {
+					return state;
+				}
+			}
+		}
+
 		for(auto state : states) {
 			if(state->compare(value))
 				return state;
@@ -86,5 +466,97 @@
 
 	}
 
+	std::shared_ptr<Abstract::State> HTTP::Agent::StateFactory(const XML::Node &node) {
+
+		if(!replicas.urls.empty() && node.attribute("expires-within")) {
+			throw std::system_error(EINVAL,std::system_category(),"Certificate states are not available with 'urls'");
+		}
+
+		if(node.attribute("phase") || node.attribute("above")) {
+			auto state = make_shared<TimingState>(node);
+			slow.push_back(state);
+			return state;
+		}
+
+		if(node.attribute("expires-within")) {
+			auto state = make_shared<CertificateState>(node);
+			expiring.push_back(state);
+			std::sort(expiring.begin(),expiring.end(),[](const std::shared_ptr<CertificateState> &a, const std::shared_ptr<CertificateState> &b){
+				return a->days < b->days;
+			});
+			return state;
+		}
+
+		return Udjat::Agent<int32_t>::StateFactory(node);
+
+	}
+
+	Value & HTTP::Agent::getProperties(Value &value) const {
+
+		Udjat::Agent<int32_t>::getProperties(value);
+
+		for(const auto &phase : phases) {
+			value[phase.name] = ((double) (timings.*(phase.field))) / 1000.0;
+		}
+
+		if(certificate.expires) {
+			value["certificate-expiration"] = expiration();
+		}
+
+		if(!replicas.values.empty()) {
+			size_t available = 0;
+			for(size_t ix = 0; ix < replicas.values.size(); ix++) {
+				value[(std::string{"replica-"} + std::to_string(ix+1)).c_str()] = replicas.values[ix];
+				if(replicas.values[ix] >= 200 && replicas.values[ix] <= 399) {
+					available++;
+				}
+			}
+			value["replicas"] = (unsigned int) replicas.values.size();
+			value["replicas-available"] = (unsigned int) available;
+		}
+
+		auto summary = latency->summary();
+		if(summary.count) {
+			for(const auto &percentile : percentiles) {
+				value[percentile.name] = ((double) (summary.*(percentile.field))) / 1000.0;
+			}
+		}
+
+		return value;
+	}
+
+	bool HTTP::Agent::getProperty(const char *key, std::string &value) const {
+
+		for(const auto &phase : phases) {
+			if(strcasecmp(key,phase.name) == 0) {
+				value = std::to_string(((double) (timings.*(phase.field))) / 1000.0);
+				return true;
+			}
+		}
+
+		if(certificate.expires && strcasecmp(key,"certificate-expiration") == 0) {
+			value = std::to_string(expiration());
+			return true;
+		}
+
+		if(strncasecmp(key,"replica-",8) == 0) {
+			size_t ix = (size_t) atoi(key+8);
+			if(ix >= 1 && ix <= replicas.values.size()) {
+				value = std::to_string(replicas.values[ix-1]);
+				return true;
+			}
+		}
+
+		for(const auto &percentile : percentiles) {
+			if(strcasecmp(key,percentile.name) == 0) {
+				value = std::to_string(((double) (latency->summary().*(percentile.field))) / 1000.0);
+				return true;
+			}
+		}
+
+		return Udjat::Agent<int32_t>::getProperty(key,value);
+
+	}
+
 
  }
\ No newline at end of file
@@ -0,0 +1,210 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements payload batching for actions.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/batch.h>
+ #include <udjat/tools/logger.h>
+ #include <cstring>
+ #include <chrono>
+ #include <system_error>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	HTTP::Batch::Framing HTTP::Batch::FramingFactory(const char *name) {
+
+		if(strcasecmp(name,"ndjson") == 0) {
+			return NDJson;
+		}
+
+		if(strcasecmp(name,"json") == 0 || strcasecmp(name,"json-array") == 0) {
+			return JsonArray;
+		}
+
+		throw system_error(EINVAL,system_category(),Logger::String{"Unexpected batch framing '",name,"'"});
+
+	}
+
+	HTTP::Batch::Batch(Framing f, const Limits &l, const std::function<bool(const std::string &body, const char *mimetype)> &s)
+		: framing{f}, limits{l}, send{s}, latency{3600} {
+
+		flusher = std::thread{[this](){
+
+			std::unique_lock<std::mutex> lock{guard};
+
+			for(;;) {
+
+				if(!ready.empty()) {
+
+					std::pair<std::string,size_t> batch{std::move(ready.front())};
+					ready.pop_front();
+
+					lock.unlock();
+					flush(batch.first,batch.second);
+					lock.lock();
+
+				} else if(items) {
+
+					// The first payload is on the batch, wait for the interval or the size limits.
+					cond.wait_for(lock,std::chrono::milliseconds(limits.interval),[this](){
+						return !enabled || !ready.empty();
+					});
+
+					if(ready.empty() || !enabled) {
+						close();
+					}
+
+				} else if(enabled) {
+
+					cond.wait(lock,[this](){ return !enabled || items || !ready.empty(); });
+
+				} else {
+
+					break;
+
+				}
+
+			}
+
+		}};
+
+	}
+
+	void HTTP::Batch::close() {
+
+		if(items) {
+			ready.emplace_back(std::move(body),items);
+			body.clear();
+			items = 0;
+		}
+
+	}
+
+	HTTP::Batch::~Batch() {
+
+		{
+			std::lock_guard<std::mutex> lock{guard};
+			enabled = false;
+			cond.notify_all();
+		}
+
+		flusher.join();
+
+	}
+
+	const char * HTTP::Batch::mimetype() const noexcept {
+		return framing == NDJson ? "application/x-ndjson" : "application/json";
+	}
+
+	void HTTP::Batch::push(const std::string &payload) {
+
+		std::lock_guard<std::mutex> lock{guard};
+
+		if(items && (items >= limits.items || body.size() + payload.size() >= limits.bytes)) {
+			// Full, the payload goes on the next batch.
+			close();
+			cond.notify_all();
+		}
+
+		if(framing == JsonArray) {
+			body += (items ? ',' : '[');
+		}
+
+		size_t from = body.size();
+		if(payload.empty() && framing == JsonArray) {
+			// Keep the array valid, an empty element would be '[,x]'.
+			body += "null";
+		} else {
+			body += payload;
+		}
+
+		if(framing == NDJson) {
+			// Line breaks outside of JSON strings are only whitespace, inside of them they're invalid.
+			for(size_t ix = from; ix < body.size(); ix++) {
+				if(body[ix] == '\n' || body[ix] == '\r') {
+					body[ix] = ' ';
+				}
+			}
+			body += '\n';
+		}
+
+		if(++items == 1) {
+			// Start the interval.
+			cond.notify_all();
+		}
+
+	}
+
+	void HTTP::Batch::flush(std::string &batch, size_t count) noexcept {
+
+		if(framing == JsonArray) {
+			batch += ']';
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		bool success = false;
+		try {
+
+			success = send(batch,mimetype());
+
+		} catch(const std::exception &e) {
+
+			Logger::String{e.what()}.error("http");
+
+		}
+
+		latency.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+		counters.flushes++;
+		counters.items += count;
+		if(!success) {
+			counters.failed++;
+		}
+
+	}
+
+	HTTP::Batch::Metrics HTTP::Batch::metrics() noexcept {
+
+		Metrics metrics;
+
+		{
+			std::lock_guard<std::mutex> lock{guard};
+			metrics.pending = items;
+			for(const auto &batch : ready) {
+				metrics.pending += batch.second;
+			}
+		}
+
+		metrics.flushes = counters.flushes.load();
+		metrics.items = counters.items.load();
+		metrics.failed = counters.failed.load();
+		metrics.latency = latency.summary();
+
+		return metrics;
+
+	}
+
+ }
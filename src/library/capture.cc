@@ -0,0 +1,207 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements sampled payload capture.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/capture.h>
+ #include <udjat/tools/configuration.h>
+ #include <udjat/tools/logger.h>
+ #include <atomic>
+ #include <mutex>
+ #include <cstdio>
+ #include <cstring>
+ #include <ctime>
+ #include <fcntl.h>
+ #include <unistd.h>
+ #include <sys/stat.h>
+ #include <sys/uio.h>
+ #include <system_error>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	HTTP::Capture::Capture(size_t l) : limit{l} {
+	}
+
+	std::unique_ptr<HTTP::Capture> HTTP::Capture::sample() noexcept {
+
+		static const unsigned int rate = Config::Value<unsigned int>("http","trace-payload",0).get();
+		if(!rate) {
+			return std::unique_ptr<Capture>{};
+		}
+
+		static atomic<uint64_t> requests{0};
+		if(requests.fetch_add(1,memory_order_relaxed) % rate) {
+			return std::unique_ptr<Capture>{};
+		}
+
+		static const size_t limit = Config::Value<unsigned int>("http","trace-payload-bytes",4096).get();
+
+		try {
+			return std::unique_ptr<Capture>{new Capture(limit)};
+		} catch(...) {
+			return std::unique_ptr<Capture>{};
+		}
+
+	}
+
+	void HTTP::Capture::append(Body &body, const void *data, size_t length, size_t limit) noexcept {
+		if(body.data.size() < limit) {
+			try {
+				body.data.append((const char *) data,std::min(length,limit - body.data.size()));
+			} catch(...) {
+				// Out of memory, keep what was captured.
+			}
+		}
+		body.length += length;
+	}
+
+	/// @brief Get the capture file name, the default is on a directory private to the process user.
+	static std::string capture_filename() {
+
+		std::string filename{Config::Value<std::string>("http","trace-payload-file","").c_str()};
+		if(!filename.empty()) {
+			return filename;
+		}
+
+		std::string dir{"/tmp/" PACKAGE_NAME "-"};
+		dir += std::to_string(geteuid());
+
+		if(mkdir(dir.c_str(),0700) && errno != EEXIST) {
+			throw system_error(errno,system_category(),dir);
+		}
+
+		// Someone else could have created it first.
+		struct stat st;
+		if(lstat(dir.c_str(),&st) || !S_ISDIR(st.st_mode) || st.st_uid != geteuid() || (st.st_mode & 077)) {
+			throw system_error(EPERM,system_category(),dir + " is not a private directory");
+		}
+
+		return dir + "/payload.log";
+
+	}
+
+	void HTTP::Capture::write(const char *method, const char *url, int status) noexcept {
+
+		static mutex guard;
+		static int fd = -1;
+		static uint64_t size = 0;
+		static bool refused = false;
+
+		static const std::string filename{[](){
+			try {
+				return capture_filename();
+			} catch(const std::exception &e) {
+				Logger::String{"Payload capture disabled: ",e.what()}.warning("http");
+			}
+			return std::string{};
+		}()};
+
+		static const uint64_t maxsize = Config::Value<unsigned int>("http","trace-payload-size",10485760).get();
+
+		if(filename.empty()) {
+			return;
+		}
+
+		char header[512];
+		char reqinfo[96];
+		char rspinfo[96];
+
+		{
+			struct timespec ts;
+			clock_gettime(CLOCK_REALTIME,&ts);
+			struct tm tm;
+			localtime_r(&ts.tv_sec,&tm);
+
+			char timestamp[32];
+			strftime(timestamp,sizeof(timestamp),"%Y-%m-%d %H:%M:%S",&tm);
+
+			snprintf(header,sizeof(header),"--- %s.%06ld %s %s status=%d\n",timestamp,ts.tv_nsec / 1000L,method,url,status);
+			snprintf(reqinfo,sizeof(reqinfo),"\n> request %llu bytes (%zu captured)\n",(unsigned long long) request.length,request.data.size());
+			snprintf(rspinfo,sizeof(rspinfo),"\n< response %llu bytes (%zu captured)\n",(unsigned long long) response.length,response.data.size());
+		}
+
+		struct iovec iov[] = {
+			{ header, strlen(header) },
+			{ reqinfo, strlen(reqinfo) },
+			{ (void *) request.data.data(), request.data.size() },
+			{ rspinfo, strlen(rspinfo) },
+			{ (void *) response.data.data(), response.data.size() },
+			{ (void *) "\n\n", 2 },
+		};
+
+		size_t length = 0;
+		for(const auto &block : iov) {
+			length += block.iov_len;
+		}
+
+		lock_guard<mutex> lock{guard};
+
+		if(fd >= 0 && maxsize && size + length > maxsize) {
+
+			// Keep the last full file as '.1'.
+			::close(fd);
+			fd = -1;
+			std::string previous{filename.c_str()};
+			previous += ".1";
+			::rename(filename.c_str(),previous.c_str());
+
+		}
+
+		if(fd < 0) {
+
+			// The bodies can have credentials, never follow a planted link or append to someone else's file.
+			fd = ::open(filename.c_str(),O_WRONLY|O_APPEND|O_CREAT|O_CLOEXEC|O_NOFOLLOW,0600);
+			if(fd < 0) {
+				if(!refused) {
+					Logger::String{"Can't open ",filename.c_str(),": ",strerror(errno)}.warning("http");
+					refused = true;
+				}
+				return;
+			}
+
+			struct stat st;
+			if(fstat(fd,&st) || !S_ISREG(st.st_mode) || st.st_uid != geteuid() || st.st_nlink != 1) {
+				if(!refused) {
+					Logger::String{"Refusing to capture payloads on ",filename.c_str(),", it is not a regular file owned by the process"}.warning("http");
+					refused = true;
+				}
+				::close(fd);
+				fd = -1;
+				return;
+			}
+
+			size = (uint64_t) st.st_size;
+			refused = false;
+
+		}
+
+		ssize_t bytes = ::writev(fd,iov,sizeof(iov)/sizeof(iov[0]));
+		if(bytes > 0) {
+			size += bytes;
+		}
+
+	}
+
+ }
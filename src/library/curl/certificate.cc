@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements server certificate capture.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/context.h>
+ #include <udjat/tools/logger.h>
+ #include <cstring>
+ #include <ctime>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	/// @brief Parse certificate date as formatted by the curl TLS backends.
+	static time_t parse_date(const char *str) noexcept {
+
+		while(*str == ' ') {
+			str++;
+		}
+
+		static const char * formats[] = {
+			"%b %d %H:%M:%S %Y",	// OpenSSL: "Mar 24 12:00:00 2025 GMT"
+			"%Y-%m-%d %H:%M:%S",	// x509asn1 (GnuTLS and others): "2025-03-24 12:00:00 GMT"
+		};
+
+		for(const char *format : formats) {
+			struct tm tm;
+			memset(&tm,0,sizeof(tm));
+			if(strptime(str,format,&tm)) {
+				return timegm(&tm);
+			}
+		}
+
+		return 0;
+
+	}
+
+	void HTTP::Context::load_certificates() noexcept {
+
+		struct curl_certinfo *info = nullptr;
+
+		if(curl_easy_getinfo(hCurl, CURLINFO_CERTINFO, &info) != CURLE_OK || !info || info->num_of_certs < 1) {
+			// No new TLS handshake (or not a TLS connection), keep the last chain.
+			return;
+		}
+
+		try {
+
+			auto &chain = handler->certinfo.chain;
+			chain.clear();
+
+			for(int ix = 0; ix < info->num_of_certs; ix++) {
+
+				HTTP::Certificate certificate;
+
+				for(struct curl_slist *item = info->certinfo[ix]; item; item = item->next) {
+
+					const char *data = item->data;
+
+					if(strncasecmp(data,"Subject:",8) == 0) {
+						certificate.subject = data+8;
+					} else if(strncasecmp(data,"Issuer:",7) == 0) {
+						certificate.issuer = data+7;
+					} else if(strncasecmp(data,"Expire date:",12) == 0) {
+						certificate.expires = parse_date(data+12);
+					}
+
+				}
+
+				chain.push_back(certificate);
+
+			}
+
+			if(Logger::enabled(Logger::Trace)) {
+				Logger::String{"Got ",chain.size()," certificate(s) from ",handler->c_str()}.trace("curl");
+			}
+
+		} catch(const std::exception &e) {
+
+			Logger::String{"Error '",e.what(),"' loading certificate chain"}.warning("curl");
+
+		}
+
+	}
+
+ }
@@ -28,7 +28,10 @@
  #include <udjat/tools/socket.h>
  #include <udjat/tools/value.h>
  #include <udjat/tools/http/mimetype.h>
+ #include <udjat/tools/http/metrics.h>
  #include <private/context.h>
+ #include <private/trace.h>
+ #include <private/probes.h>
  #include <udjat/tools/string.h>
  
  #if __cplusplus >= 201703L 
@@ -36,6 +39,7 @@
  #endif
 
  #include <errno.h>
+ #include <ctype.h>
  #include <curl/curl.h>
  #include <fcntl.h>
  #include <unistd.h>
@@ -95,14 +99,35 @@
 
 	};
 
-#if __cplusplus >= 201703L	
 	HTTP::Context::Context(HTTP::Handler &h, const std::function<bool(uint64_t current, uint64_t total, const void *data, size_t len)> &w) 
-		: handler{&h}, write{&w} {
-#else
-	HTTP::Context::Context(HTTP::Handler &h, const std::function<bool(uint64_t current, uint64_t total, const void *data, size_t len)> &w) {
-		handler = &h;
-		write = &w;	
-#endif
+		: Context{h} {
+		write = &w;
+	}
+
+	HTTP::Context::Context(HTTP::Handler &h, HTTP::Sink &s) 
+		: Context{h} {
+		sink = &s;
+	}
+
+	/// @brief Get 'host[:port]' from URL.
+	static std::string hostname(const char *url) {
+
+		const char *ptr = strstr(url,"://");
+		ptr = (ptr ? ptr+3 : url);
+
+		size_t length = strcspn(ptr,"/?#");
+
+		// Remove user info.
+		const char *at = (const char *) memchr(ptr,'@',length);
+		if(at) {
+			length -= (at+1-ptr);
+			ptr = at+1;
+		}
+
+		return std::string{ptr,length};
+	}
+
+	HTTP::Context::Context(HTTP::Handler &h) : handler{&h}, host{hostname(h.url.c_str())}, id{Trace::id()} {
 
 		CurlSingleton::instance();
 
@@ -114,14 +139,14 @@
 		curl_easy_setopt(hCurl, CURLOPT_WRITEDATA, this);
 
 		curl_easy_setopt(hCurl, CURLOPT_FOLLOWLOCATION, 1L);
-		curl_easy_setopt(hCurl, CURLOPT_FORBID_REUSE, 1L);
 		curl_easy_setopt(hCurl, CURLOPT_URL, handler->url.c_str());
 
+		// Keep the connection open for the next request from the same handler.
+		curl_easy_setopt(hCurl, CURLOPT_FORBID_REUSE, (Config::Value<bool>("http","keep-alive",true).get() ? 0L : 1L));
+
 		curl_easy_setopt(hCurl, CURLOPT_ERRORBUFFER, error.message);
 
 		curl_easy_setopt(hCurl, CURLOPT_OPENSOCKETDATA, this);
-		curl_easy_setopt(hCurl, CURLOPT_OPENSOCKETFUNCTION, open_socket_callback);
-		// curl_easy_setopt(hCurl, CURLOPT_CONNECTTIMEOUT, Config::Value<long>("http","timeout",10).get());
 
 		curl_easy_setopt(hCurl, CURLOPT_SOCKOPTDATA, this);
 		curl_easy_setopt(hCurl, CURLOPT_SOCKOPTFUNCTION, sockopt_callback);
@@ -135,18 +160,66 @@
 		curl_easy_setopt(hCurl, CURLOPT_READDATA, this);
 		curl_easy_setopt(hCurl, CURLOPT_READFUNCTION, read_callback);
 
-		// Load heaers
-		if(!handler->headers.request.empty()) {
+		curl_easy_setopt(hCurl, CURLOPT_XFERINFODATA, this);
+		curl_easy_setopt(hCurl, CURLOPT_XFERINFOFUNCTION, xferinfo_callback);
+
+#if defined(HAVE_USDT) && LIBCURL_VERSION_NUM >= 0x075000
+		curl_easy_setopt(hCurl, CURLOPT_PREREQDATA, this);
+		curl_easy_setopt(hCurl, CURLOPT_PREREQFUNCTION, prereq_callback);
+#endif // HAVE_USDT
+
+		HTTP_PROBE(context__create,id,handler->c_str());
+
+		configure();
+
+	}
+
+	void HTTP::Context::configure(bool multi) {
+
+		// The blocking connect would serialize the transfers on a multi handle, let curl open the sockets.
+		curl_easy_setopt(hCurl, CURLOPT_OPENSOCKETFUNCTION, (multi ? nullptr : open_socket_callback));
+
+		// Deadlines
+		curl_easy_setopt(hCurl, CURLOPT_CONNECTTIMEOUT, (long) handler->deadline.connect);
+		curl_easy_setopt(hCurl, CURLOPT_TIMEOUT, (long) handler->deadline.total);
+
+		if(handler->deadline.lowspeed.limit && handler->deadline.lowspeed.time) {
+			curl_easy_setopt(hCurl, CURLOPT_LOW_SPEED_LIMIT, (long) handler->deadline.lowspeed.limit);
+			curl_easy_setopt(hCurl, CURLOPT_LOW_SPEED_TIME, (long) handler->deadline.lowspeed.time);
+		} else {
+			curl_easy_setopt(hCurl, CURLOPT_LOW_SPEED_LIMIT, 0L);
+			curl_easy_setopt(hCurl, CURLOPT_LOW_SPEED_TIME, 0L);
+		}
+
+		// Progress notifications are sent apart from the data writer.
+		curl_easy_setopt(hCurl, CURLOPT_NOPROGRESS, (handler->notify.callback ? 0L : 1L));
+
+		if(buffer.data.size() != handler->buffersize) {
+			buffer.data.resize(handler->buffersize);
+		}
+
+		curl_easy_setopt(hCurl, CURLOPT_CERTINFO, (handler->certinfo.enabled ? 1L : 0L));
+
+		// Build header list, only rebuilt when headers were added to the handler.
+		if(headers.count != handler->headers.request.size()) {
+
+			if(headers.request) {
+				curl_slist_free_all(headers.request);
+				headers.request = nullptr;
+			}
+
 			for(const auto &header : handler->headers.request) {
-				headers.request = curl_slist_append(headers.request,String{header.name,": ",header.value}.c_str());
+				headers.request = curl_slist_append(headers.request,String{header.name(),": ",header.value}.c_str());
 			}
-		}
 
-		
+			headers.count = handler->headers.request.size();
+
+		}
 
 	}
 	
 	HTTP::Context::~Context() {
+		digest_reset();
 		curl_easy_cleanup(hCurl);
 		if(headers.request) {
 			curl_slist_free_all(headers.request);
@@ -155,6 +228,10 @@
 
 	void HTTP::Context::set(const HTTP::Method method) {
 
+		// Undo the options of the previous request on this handle.
+		curl_easy_setopt(hCurl, CURLOPT_CUSTOMREQUEST, NULL);
+		curl_easy_setopt(hCurl, CURLOPT_NOBODY, 0L);
+
 		switch(method) {
 		case HTTP::Get:
 			curl_easy_setopt(hCurl, CURLOPT_HTTPGET, 1L);
@@ -180,20 +257,37 @@
 			throw std::system_error(EINVAL,std::system_category(),"Unsupported HTTP verb");
 		}
 
-		if(Config::Value<bool>("http","trace",TRACE_DEFAULT).get()) {
+		tracing = Config::Value<bool>("http","trace",TRACE_DEFAULT).get();
+		if(tracing) {
 			curl_easy_setopt(hCurl, CURLOPT_VERBOSE, 1L);
 			curl_easy_setopt(hCurl, CURLOPT_DEBUGDATA, this);
 			curl_easy_setopt(hCurl, CURLOPT_DEBUGFUNCTION, trace_callback);
+		} else {
+			curl_easy_setopt(hCurl, CURLOPT_VERBOSE, 0L);
+			curl_easy_setopt(hCurl, CURLOPT_DEBUGFUNCTION, NULL);
 		}
 
 	}
 
-	int HTTP::Context::test(const HTTP::Method method, const char *pl) noexcept {
+	int HTTP::Context::test(const HTTP::Method method, const char *pl, bool body) noexcept {
+
+		try {
+
+			set(method);
+
+		} catch(const std::exception &e) {
+
+			handler->status.message = e.what();
+			return -EINVAL;
+
+		}
 
-		set(method);
 		payload.text = pl;
 
-		curl_easy_setopt(hCurl, CURLOPT_WRITEFUNCTION, no_write_callback);
+		// Tests do not keep the body, there is nothing to verify.
+		digest_reset();
+
+		curl_easy_setopt(hCurl, CURLOPT_WRITEFUNCTION, (body ? write_callback : no_write_callback));
 
 		return perform(false);
 	}
@@ -203,24 +297,142 @@
 		set(method);
 		payload.text = pl;
 
+		// Can throw on unsupported algorithm, only from here since test() is noexcept.
+		digest_init();
+
 		curl_easy_setopt(hCurl, CURLOPT_WRITEFUNCTION, write_callback);
 
 		return perform(true);
 
 	}
 
-	int HTTP::Context::perform(bool except) {
+	int HTTP::Context::prepare(const HTTP::Method method, const char *pl) noexcept {
+
+		try {
+
+			set(method);
+
+		} catch(const std::exception &e) {
+
+			handler->status.message = e.what();
+			return -EINVAL;
+
+		}
+
+		payload.text = pl;
+		digest_reset();
+
+		curl_easy_setopt(hCurl, CURLOPT_WRITEFUNCTION, no_write_callback);
+
+		configure(true);
+		start();
+
+		return 0;
+
+	}
+
+	void HTTP::Context::start() {
 
 		debug(__FUNCTION__," handler=",handler->c_str());
 
+		// The handle is reused, nothing from the previous transfer can leak into this one.
 		handler->headers.response.clear();
+		current = 0;
+		total = 0;
+		error.system = 0;
+		error.message[0] = 0;
+		verified = false;
 		payload.ptr = nullptr;
+		capture = Capture::sample();
+		progress.current = 0;
+		progress.last = std::chrono::steady_clock::now();
+		buffer.used = 0;
+		buffer.calls = 0;
 
 		if(headers.request) {
 			curl_easy_setopt(hCurl, CURLOPT_HTTPHEADER, headers.request);
 		}
 
-		CURLcode res = curl_easy_perform(hCurl);
+	}
+
+	int HTTP::Context::perform(bool except) {
+		start();
+		return complete(curl_easy_perform(hCurl),except);
+	}
+
+	int HTTP::Context::complete(CURLcode res, bool except) {
+
+		{
+			// Get phase timings, even on failure they tell where the time was spent.
+			static const struct {
+				CURLINFO info;
+				uint64_t HTTP::Timings::*field;
+			} phases[] = {
+				{ CURLINFO_NAMELOOKUP_TIME_T,		&HTTP::Timings::namelookup		},
+				{ CURLINFO_CONNECT_TIME_T,			&HTTP::Timings::connect			},
+				{ CURLINFO_APPCONNECT_TIME_T,		&HTTP::Timings::appconnect		},
+				{ CURLINFO_PRETRANSFER_TIME_T,		&HTTP::Timings::pretransfer		},
+				{ CURLINFO_STARTTRANSFER_TIME_T,	&HTTP::Timings::starttransfer	},
+				{ CURLINFO_TOTAL_TIME_T,			&HTTP::Timings::total			},
+			};
+
+			for(const auto &phase : phases) {
+				curl_off_t value = 0;
+				curl_easy_getinfo(hCurl, phase.info, &value);
+				handler->timings.*(phase.field) = (uint64_t) value;
+			}
+		}
+
+		if(handler->certinfo.enabled) {
+			load_certificates();
+		}
+
+		if(res == CURLE_OK && buffer.used) {
+
+			// Send the last coalesced block.
+			try {
+
+				if(flush()) {
+					system_error(ECANCELED);
+					res = CURLE_ABORTED_BY_CALLBACK;
+				}
+
+			} catch(const std::exception &e) {
+
+				exception(e);
+				res = CURLE_WRITE_ERROR;
+
+			}
+
+		}
+
+		if(res == CURLE_OK && (sink || !handler->digests.empty())) {
+
+			try {
+
+				digest_verify();
+
+				if(sink) {
+					sink->finalize();
+				}
+
+			} catch(const std::exception &e) {
+
+				exception(e);
+				res = CURLE_WRITE_ERROR;
+
+			}
+
+		}
+
+		if(res != CURLE_OK && sink) {
+			// Wake up consumers waiting for the rest of the response.
+			sink->abort(error.system ? -error.system : EIO);
+		}
+
+		if(buffer.calls && Logger::enabled(Logger::Debug)) {
+			Logger::String{"Delivered ",current," bytes in ",buffer.calls," writer call(s)"}.write(Logger::Debug,"curl");
+		}
 
 		debug("length=",total," message='",error.message,"' syserror=",error.system);
 
@@ -230,16 +442,54 @@
 			handler->status.message = strerror(error.system);
 		}
 
+		if(res == CURLE_OK && handler->notify.callback && notify(current,total,true)) {
+			// Canceled on the last notification.
+			system_error(ECANCELED);
+			res = CURLE_ABORTED_BY_CALLBACK;
+		}
+
+		long response_code = 0;
+		curl_easy_getinfo(hCurl, CURLINFO_RESPONSE_CODE, &response_code);
+		handler->status.code = (int) response_code;
+
+		{
+			curl_off_t sent = 0;
+			curl_off_t received = 0;
+			curl_easy_getinfo(hCurl, CURLINFO_SIZE_UPLOAD_T, &sent);
+			curl_easy_getinfo(hCurl, CURLINFO_SIZE_DOWNLOAD_T, &received);
+			HTTP::Metrics::record(host,(int) res,(int) response_code,(uint64_t) sent,(uint64_t) received,handler->timings.total);
+			HTTP_PROBE(complete,id,handler->c_str(),(int) response_code,(uint64_t) received,handler->timings.total);
+		}
+
+		if(capture) {
+			const char *method = "";
+#if LIBCURL_VERSION_NUM >= 0x074800
+			curl_easy_getinfo(hCurl, CURLINFO_EFFECTIVE_METHOD, &method);
+#endif // LIBCURL_VERSION_NUM
+			capture->write((method ? method : ""),handler->c_str(),(res == CURLE_OK ? (int) response_code : (int) res));
+			capture.reset();
+		}
+
 		if(res == CURLE_OK) {
-			long response_code = 0;
-			curl_easy_getinfo(hCurl, CURLINFO_RESPONSE_CODE, &response_code);
 			debug("result=CURLE_OK, response_code=",response_code," except=",except);	
-			handler->status.code = (int) response_code;
+			return response_code;
+		}
+
+		if(!except && response_code && error.system == -ECANCELED) {
+			// Stopped by the application after the response headers, the status is the result.
+			debug("Canceled by application, response_code=",response_code);
 			return response_code;
 		}
 
 		debug("Curl response=",res," '",curl_easy_strerror(res),"' message='",handler->status.message.c_str(),"'");
 
+		HTTP_PROBE(error,id,handler->c_str(),(int) res,(error.message[0] ? error.message : curl_easy_strerror(res)));
+
+		if(tracing && Logger::enabled(Logger::Debug)) {
+			Logger::String{"Transfer events of failed request to ",handler->c_str()}.write(Logger::Debug,"curl");
+			Trace::write(id);
+		}
+
 		if(except) {
 			if(error.system) {
 				throw CurlException(
@@ -264,6 +514,26 @@
 
 		size_t realsize = size * nitems;
 
+		if(context->handler->upload) {
+
+			// Body written by the application, straight into the curl buffer.
+			try {
+
+				size_t length = context->handler->upload(buffer,realsize);
+				if(context->capture && length <= realsize) {
+					context->capture->sent(buffer,length);
+				}
+				return length;
+
+			} catch(const std::exception &e) {
+
+				context->exception(e);
+				return CURL_READFUNC_ABORT;
+
+			}
+
+		}
+
 		if(!context->payload.ptr) {
 			
 			if(context->payload.text.empty()) {
@@ -284,6 +554,10 @@
 			memcpy(buffer,context->payload.ptr,len);
 			context->payload.ptr += len;
 
+			if(context->capture) {
+				context->capture->sent(buffer,len);
+			}
+
 			return len;
 
 		}
@@ -292,28 +566,94 @@
 
 	}
 
-	size_t HTTP::Context::no_write_callback(void *, size_t size, size_t nmemb, Context *) noexcept {
+	size_t HTTP::Context::no_write_callback(void *contents, size_t size, size_t nmemb, Context *context) noexcept {
+		HTTP_PROBE(write,context->id,(uint64_t) (size * nmemb),context->current);
+		if(context->capture) {
+			context->capture->received(contents,size * nmemb);
+		}
 		return size * nmemb;
 	}
 
+	bool HTTP::Context::deliver(const void *data, size_t len) {
+
+		buffer.calls++;
+
+		if(!handler->digests.empty()) {
+			digest_update(data,len);
+			if(total && current + len == total) {
+				// Last block, verify before delivering it.
+				digest_verify();
+			}
+		}
+
+		if(sink) {
+			sink->write(current,data,len);
+		} else if((*write)(current,total,data,len)) {
+			return true;
+		}
+
+		current += len;
+		return false;
+
+	}
+
+	bool HTTP::Context::flush() {
+
+		if(!buffer.used) {
+			return false;
+		}
+
+		size_t len = buffer.used;
+		buffer.used = 0;
+		return deliver(buffer.data.data(),len);
+
+	}
+
 	size_t HTTP::Context::write_callback(void *contents, size_t size, size_t nmemb, Context *context) noexcept {
 
 		size_t realsize = size * nmemb;
 
-		debug("----> realsize=",realsize,"\n",std::string{(const char *) contents,realsize}.c_str(),"\n");
+		HTTP_PROBE(write,context->id,(uint64_t) realsize,context->current);
 
 		try {
 
-			if((*context->write)(context->current,context->total,(const char *) contents, realsize)) {
-				if(Logger::enabled(Logger::Debug)) {
-					Logger::String{"HTTP action was canceled by the application"}.write(Logger::Debug, "curl");
-				}
-				context->system_error(ECANCELED);
+			if(context->capture) {
+				context->capture->received(contents,realsize);
+			}
+
+			bool canceled = false;
+
+			if(context->buffer.data.empty()) {
+
+				canceled = context->deliver(contents,realsize);
+
 			} else {
-				context->current += realsize;
+
+				// Coalesce small chunks, large ones are sent directly.
+				if(context->buffer.used + realsize > context->buffer.data.size()) {
+					canceled = context->flush();
+				}
+
+				if(!canceled) {
+					if(realsize >= context->buffer.data.size()) {
+						canceled = context->deliver(contents,realsize);
+					} else {
+						memcpy(context->buffer.data.data()+context->buffer.used,contents,realsize);
+						context->buffer.used += realsize;
+					}
+				}
+
+			}
+
+			if(!canceled) {
 				return realsize;
 			}
 
+			if(Logger::enabled(Logger::Debug)) {
+				Logger::String{"HTTP action was canceled by the application"}.write(Logger::Debug, "curl");
+			}
+			context->system_error(ECANCELED);
+
 		} catch(const std::exception &e) {
 
 			if(Logger::enabled(Logger::Debug)) {
@@ -336,46 +676,63 @@
 
 	}
 
-	int HTTP::Context::trace_callback(CURL *handle, curl_infotype type, char *data, size_t size, Context *context) noexcept {
+	bool HTTP::Context::notify(uint64_t current, uint64_t total, bool force) noexcept {
 
-		Logger::String logger{""};
+		if(current == progress.current && (current || !force)) {
+			return false;
+		}
 
-		switch (type) {
-		case CURLINFO_TEXT:
-			logger.append(data,size);
-			return 0;
+		auto now = std::chrono::steady_clock::now();
 
-		case CURLINFO_HEADER_OUT:
-			logger.append("=> Send header");
-			break;
+		if(!force 
+			&& (current - progress.current) < handler->notify.step
+			&& std::chrono::duration_cast<std::chrono::milliseconds>(now - progress.last).count() < handler->notify.interval) {
+			return false;
+		}
 
-		case CURLINFO_DATA_OUT:
-			logger.append("=> Send data");
-			break;
+		progress.current = current;
+		progress.last = now;
 
-		case CURLINFO_SSL_DATA_OUT:
-			logger.append("=> Send SSL data");
-			break;
+		try {
 
-		case CURLINFO_HEADER_IN:
-			logger.append("<= Recv header (",size," bytes)");
-			break;
+			if(handler->notify.callback(current,total)) {
+				if(Logger::enabled(Logger::Debug)) {
+					Logger::String{"HTTP action was canceled by the progress notifier"}.write(Logger::Debug, "curl");
+				}
+				return true;
+			}
 
-		case CURLINFO_DATA_IN:
-			logger.append("<= Recv data (",size," bytes)");
-			break;
+		} catch(const std::exception &e) {
 
-		case CURLINFO_SSL_DATA_IN:
-			logger.append("<= Recv SSL data");
-			break;
+			Logger::String{"Error '",e.what(),"' on progress notifier"}.warning("curl");
 
-		default:
-			debug("Unexpected type '",type,"'");
-			return 0;
+		} catch(...) {
+
+			Logger::String{"Unexpected error on progress notifier"}.warning("curl");
 
 		}
 
-		logger.write(Logger::Debug,"curl");
+		return false;
+
+	}
+
+	int HTTP::Context::xferinfo_callback(Context *context, curl_off_t dltotal, curl_off_t dlnow, curl_off_t, curl_off_t) noexcept {
+
+		if(context->notify((uint64_t) dlnow, (dltotal > 0 ? (uint64_t) dltotal : context->total))) {
+			context->system_error(ECANCELED);
+			return 1;
+		}
+
+		return 0;
+
+	}
+
+	int HTTP::Context::trace_callback(CURL *, curl_infotype type, char *, size_t size, Context *context) noexcept {
+
+		// Binary record on the thread ring, the events are formatted only when dumped.
+		if(type <= CURLINFO_SSL_DATA_OUT) {
+			Trace::record(context->id,(Trace::Type) type,size);
+		}
 
 		return 0;
 
@@ -385,9 +742,10 @@
 
 		debug("Context=",((unsigned long long) context)," handler=",context->handler->c_str());
 
-		int seconds = Config::Value<unsigned int>("network","timeout",10).get();
-
-		// curl_easy_setopt(context->hCurl, CURLOPT_CONNECTTIMEOUT, seconds);
+		int seconds = context->handler->deadline.connect;
+		if(!seconds) {
+			seconds = Config::Value<unsigned int>("network","timeout",10).get();
+		}
 
 		Logger::String{"Connecting to ",context->handler->c_str()," with timeout of ",seconds," seconds"}.trace("curl");
 
@@ -492,22 +850,47 @@
 			context->set_local(addr);
 		}
 
+		HTTP_PROBE(connect,context->id,context->handler->c_str(),(int) curlfd);
+
+		// Sockets from open_socket_callback are connected, on multi handles curl connects them after this call.
 		length = sizeof(addr);
 		if(!getpeername(curlfd, (sockaddr *) &addr, &length)) {
 			context->set_remote(addr);
+			return CURL_SOCKOPT_ALREADY_CONNECTED;
+		}
+
+		return CURL_SOCKOPT_OK;
+	}
+
+#if defined(HAVE_USDT) && LIBCURL_VERSION_NUM >= 0x075000
+	int HTTP::Context::prereq_callback(Context *context, char *, char *, int, int) noexcept {
+
+		// Connected (and the TLS handshake done) for the request, a reused connection has no handshake time.
+		curl_off_t appconnect = 0;
+		curl_easy_getinfo(context->hCurl, CURLINFO_APPCONNECT_TIME_T, &appconnect);
+		if(appconnect) {
+			HTTP_PROBE(tls__done,context->id,context->handler->c_str(),(uint64_t) appconnect);
 		}
 
-		return CURL_SOCKOPT_ALREADY_CONNECTED;
+		return CURL_PREREQFUNC_OK;
 	}
+#endif // HAVE_USDT
 
 	size_t HTTP::Context::header_callback(char *buffer, size_t size, size_t nitems, Context *context) noexcept {
 
-		String header{(const char *) buffer,(size_t) (size*nitems)};
-		debug("header=",header);
+		size_t length = size*nitems;
+		debug("header=",std::string{buffer,length});
 
 		try {
 
-			if(strncasecmp(header.c_str(),"HTTP/",5) == 0 && header.size()) {
+			if(length > 5 && strncasecmp(buffer,"HTTP/",5) == 0) {
+
+				// New response (followed redirect, 100-continue), the previous headers and Content-Length do not apply.
+				context->handler->headers.response.clear();
+				context->total = 0;
+				context->current = 0;
+
+				String header{(const char *) buffer,length};
 
 				unsigned int v[2];
 				unsigned int code;
@@ -524,26 +907,54 @@
 					}
 
 					strncpy(context->error.message,str,CURL_ERROR_SIZE);
+
+					HTTP_PROBE(first__byte,context->id,context->handler->c_str(),code);
 				
 				}
 
+			} else if(length > 15 && strncasecmp(buffer,"Content-Length:",15) == 0) {
 
-			} else if(strncasecmp(header.c_str(),"Content-Length:",15) == 0 && header.size()) {
-
-				char *end = nullptr;
-				context->total = strtoull(header.c_str()+16,&end,10);
-				(*(context->write))(0,context->total,nullptr,0);
+				context->total = strtoull(String{buffer+15,length-15}.c_str(),nullptr,10);
+				if(context->sink) {
+					context->sink->allocate(context->total);
+				} else {
+					(*(context->write))(0,context->total,nullptr,0);
+				}
 
-			} else if(!header.strip().empty()) {
+			} else {
 
-				const char *from = header.c_str();
-				const char *delimiter = strchr(from,':');
+				// Split 'name: value' without intermediate strings.
+				const char *end = buffer+length;
+				const char *delimiter = (const char *) memchr(buffer,':',length);
 
 				if(delimiter) {
-					context->handler->headers.response.emplace_back(
-						String{from,(size_t) (delimiter-from)}.strip().c_str(),
-						String{delimiter+1}.strip().c_str()
-					);
+
+					const char *name = buffer;
+					while(name < delimiter && isspace((unsigned char) *name)) {
+						name++;
+					}
+
+					const char *nend = delimiter;
+					while(nend > name && isspace((unsigned char) *(nend-1))) {
+						nend--;
+					}
+
+					const char *value = delimiter+1;
+					while(value < end && isspace((unsigned char) *value)) {
+						value++;
+					}
+
+					while(end > value && isspace((unsigned char) *(end-1))) {
+						end--;
+					}
+
+					if(nend > name) {
+						context->handler->headers.response.emplace_back(
+							name,(size_t) (nend-name),
+							value,(size_t) (end-value)
+						);
+					}
+
 				}
 
 			}
@@ -560,7 +971,7 @@
 
 		}
 
-		return size*nitems;
+		return length;
 
 	}
 
@@ -0,0 +1,253 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements digest verification on the write path.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/context.h>
+ #include <udjat/tools/logger.h>
+ #include <udjat/tools/string.h>
+ #include <system_error>
+ #include <stdexcept>
+ #include <cctype>
+
+ using namespace std;
+
+ namespace Udjat {
+
+#ifdef HAVE_LIBCRYPTO
+
+	/// @brief Get digest name as used by openssl ("SHA-256" -> "sha256").
+	static std::string normalize(const char *name, size_t length) {
+		std::string rc;
+		for(size_t ix = 0; ix < length && name[ix]; ix++) {
+			if(name[ix] != '-') {
+				rc += (char) tolower((unsigned char) name[ix]);
+			}
+		}
+		return rc;
+	}
+
+	/// @brief Decode hex or base64 digest.
+	static std::string decode(const std::string &str, size_t length) {
+
+		std::string rc;
+
+		if(str.size() == length * 2) {
+
+			// Hexadecimal
+			for(size_t ix = 0; ix < str.size(); ix += 2) {
+				char hex[3] = { str[ix], str[ix+1], 0 };
+				if(!isxdigit((unsigned char) hex[0]) || !isxdigit((unsigned char) hex[1])) {
+					rc.clear();
+					break;
+				}
+				rc += (char) strtoul(hex,nullptr,16);
+			}
+
+			if(rc.size() == length) {
+				return rc;
+			}
+
+		}
+
+		// Base64
+		static const std::string digits{"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"};
+
+		rc.clear();
+		unsigned int bits = 0;
+		int count = 0;
+		for(char chr : str) {
+			if(chr == '=') {
+				break;
+			}
+			size_t pos = digits.find(chr == '-' ? '+' : (chr == '_' ? '/' : chr));
+			if(pos == std::string::npos) {
+				continue;
+			}
+			bits = (bits << 6) | (unsigned int) pos;
+			count += 6;
+			if(count >= 8) {
+				count -= 8;
+				rc += (char) ((bits >> count) & 0xFF);
+			}
+		}
+
+		return rc;
+
+	}
+
+	/// @brief Search for the expected digest on the response headers.
+	static std::string expected(const HTTP::Handler &handler, const std::string &algorithm) {
+
+		// RFC 9530 (Repr-Digest/Content-Digest: sha-256=:base64:) and RFC 3230 (Digest: SHA-256=base64).
+		for(const char *name : { "Repr-Digest", "Content-Digest", "Digest" }) {
+
+			const char *value = handler.header(name);
+
+			while(value && *value) {
+
+				while(*value == ' ' || *value == ',') {
+					value++;
+				}
+
+				const char *delimiter = strchr(value,'=');
+				if(!delimiter) {
+					break;
+				}
+
+				const char *end = strchr(delimiter,',');
+				if(!end) {
+					end = delimiter + strlen(delimiter);
+				}
+
+				if(normalize(value,delimiter-value) == algorithm) {
+					String digest{delimiter+1,(size_t) (end-delimiter-1)};
+					digest.strip();
+					if(digest.size() > 1 && digest[0] == ':') {
+						digest = digest.substr(1,digest.size()-2);
+					}
+					return digest;
+				}
+
+				value = end;
+			}
+
+		}
+
+		if(algorithm == "md5") {
+			return handler.header("Content-MD5");
+		}
+
+		return "";
+
+	}
+
+	void HTTP::Context::digest_init() {
+
+		verified = false;
+
+		for(size_t ix = 0; ix < handler->digests.size(); ix++) {
+
+			auto &digest = handler->digests[ix];
+			digest.value.clear();
+
+			if(ix >= digests.size()) {
+				digests.push_back(EVP_MD_CTX_new());
+			}
+
+			const EVP_MD *md = EVP_get_digestbyname(normalize(digest.algorithm.c_str(),digest.algorithm.size()).c_str());
+			if(!md) {
+				throw std::system_error(ENOTSUP,system_category(),String{"Unsupported digest '",digest.algorithm,"'"});
+			}
+
+			EVP_DigestInit_ex(digests[ix], md, NULL);
+
+		}
+
+	}
+
+	void HTTP::Context::digest_reset() noexcept {
+		for(auto ctx : digests) {
+			EVP_MD_CTX_free(ctx);
+		}
+		digests.clear();
+	}
+
+	void HTTP::Context::digest_update(const void *data, size_t len) {
+		for(auto ctx : digests) {
+			if(!EVP_DigestUpdate(ctx, data, len)) {
+				throw runtime_error("Error updating response digest");
+			}
+		}
+	}
+
+	void HTTP::Context::digest_verify() {
+
+		if(verified || digests.empty()) {
+			return;
+		}
+		verified = true;
+
+		long response_code = 0;
+		curl_easy_getinfo(hCurl, CURLINFO_RESPONSE_CODE, &response_code);
+		if(response_code < 200 || response_code > 299) {
+			// Not the requested content, nothing to verify.
+			return;
+		}
+
+		for(size_t ix = 0; ix < handler->digests.size(); ix++) {
+
+			auto &digest = handler->digests[ix];
+
+			unsigned char md[EVP_MAX_MD_SIZE];
+			unsigned int length = 0;
+
+			if(!EVP_DigestFinal_ex(digests[ix], md, &length)) {
+				throw runtime_error("Error finalizing response digest");
+			}
+
+			static const char *hexdigits = "0123456789abcdef";
+			digest.value.resize(length*2);
+			for(unsigned int byte = 0; byte < length; byte++) {
+				digest.value[byte*2] = hexdigits[md[byte] >> 4];
+				digest.value[(byte*2)+1] = hexdigits[md[byte] & 0x0F];
+			}
+
+			std::string value{
+				digest.expected.empty() 
+					? expected(*handler,normalize(digest.algorithm.c_str(),digest.algorithm.size())) 
+					: digest.expected
+			};
+
+			if(value.empty()) {
+				throw std::system_error(ENODATA,system_category(),String{"No '",digest.algorithm,"' digest to verify the response from ",handler->c_str()});
+			}
+
+			if(decode(value,length) != std::string{(const char *) md,length}) {
+				throw std::system_error(EBADMSG,system_category(),String{"The '",digest.algorithm,"' digest of the response from ",handler->c_str()," does not match"});
+			}
+
+			Logger::String{"Response ",digest.algorithm," digest is ",digest.value}.trace("curl");
+
+		}
+
+	}
+
+#else
+
+	void HTTP::Context::digest_init() {
+		verified = false;
+	}
+
+	void HTTP::Context::digest_reset() noexcept {
+	}
+
+	void HTTP::Context::digest_update(const void *, size_t) {
+	}
+
+	void HTTP::Context::digest_verify() {
+	}
+
+#endif // HAVE_LIBCRYPTO
+
+ }
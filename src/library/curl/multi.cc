@@ -0,0 +1,146 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements concurrent tests with curl multi.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/context.h>
+ #include <udjat/tools/logger.h>
+ #include <memory>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	static const std::function<bool(uint64_t current, uint64_t total, const void *data, size_t len)> discard = [](uint64_t, uint64_t, const void *, size_t) {
+		return false;
+	};
+
+	static inline bool success(int rc) noexcept {
+		return rc >= 200 && rc <= 399;
+	}
+
+	std::vector<int> HTTP::Handler::test(const std::vector<HTTP::Handler *> &handlers, size_t needed, const HTTP::Method method, const char *payload) {
+
+		std::vector<int> results(handlers.size(),0);
+		std::vector<Context *> contexts;
+		std::vector<std::unique_lock<std::mutex>> locks;
+		std::vector<std::unique_ptr<Context>> temporaries;
+
+		CURLM *multi = curl_multi_init();
+		if(!multi) {
+			throw std::system_error(ENOMEM,std::system_category(),"Cant initialize curl multi handle");
+		}
+
+		size_t pending = 0;
+		size_t succeeded = 0;
+
+		for(size_t ix = 0; ix < handlers.size(); ix++) {
+
+			HTTP::Handler *handler = handlers[ix];
+
+			// Use the cached context of the handler, unless it is busy.
+			bool duplicated = false;
+			for(size_t prev = 0; prev < ix; prev++) {
+				duplicated |= (handlers[prev] == handler);
+			}
+
+			std::unique_lock<std::mutex> lock;
+			if(!duplicated) {
+				lock = std::unique_lock<std::mutex>{handler->cache.guard,std::try_to_lock};
+			}
+
+			if(lock.owns_lock()) {
+				if(handler->cache.context) {
+					handler->cache.context->bind(discard);
+				} else {
+					handler->cache.context.reset(new Context{*handler,discard});
+				}
+				contexts.push_back(handler->cache.context.get());
+				locks.push_back(std::move(lock));
+			} else {
+				temporaries.emplace_back(new Context{*handler,discard});
+				contexts.push_back(temporaries.back().get());
+			}
+
+			results[ix] = contexts[ix]->prepare(method,payload);
+			if(!results[ix]) {
+				curl_multi_add_handle(multi,contexts[ix]->handle());
+				pending++;
+			}
+
+		}
+
+		while(pending) {
+
+			int running = 0;
+			CURLMcode mc = curl_multi_perform(multi,&running);
+			if(mc != CURLM_OK) {
+				Logger::String{"Unexpected error on concurrent test: ",curl_multi_strerror(mc)}.error("curl");
+				break;
+			}
+
+			int left = 0;
+			CURLMsg *msg;
+			while((msg = curl_multi_info_read(multi,&left)) != NULL) {
+
+				if(msg->msg != CURLMSG_DONE) {
+					continue;
+				}
+
+				for(size_t ix = 0; ix < contexts.size(); ix++) {
+					if(contexts[ix]->handle() == msg->easy_handle) {
+						results[ix] = contexts[ix]->complete(msg->data.result,false);
+						if(success(results[ix])) {
+							succeeded++;
+						}
+						break;
+					}
+				}
+
+				curl_multi_remove_handle(multi,msg->easy_handle);
+				pending--;
+
+			}
+
+			if(needed && (succeeded >= needed || succeeded + pending < needed)) {
+				// The result is known, no need to wait for the slower ones.
+				break;
+			}
+
+			if(pending && running) {
+				curl_multi_wait(multi,NULL,0,1000,NULL);
+			}
+
+		}
+
+		for(auto context : contexts) {
+			curl_multi_remove_handle(multi,context->handle());
+		}
+
+		curl_multi_cleanup(multi);
+
+		return results;
+
+	}
+
+ }
@@ -31,6 +31,7 @@
  #include <udjat/tools/http/mimetype.h>
 
  #include <private/context.h>
+ #include <private/json.h>
  #include <errno.h>
  #include <curl/curl.h>
  #include <fcntl.h>
@@ -55,7 +56,13 @@
 
  namespace Udjat {
 
-	HTTP::Handler::Handler(const URL &u) : url{u} {
+	HTTP::Handler::Handler(const URL &u) : buffersize{Config::Value<unsigned int>("http","write-buffer",0).get()}, url{u} {
+
+		deadline.connect = Config::Value<unsigned int>("curl","connect-timeout",Config::Value<unsigned int>("network","timeout",10).get()).get();
+		deadline.total = Config::Value<unsigned int>("curl","timeout",0).get();
+		deadline.lowspeed.limit = Config::Value<unsigned int>("curl","low-speed-limit",0).get();
+		deadline.lowspeed.time = Config::Value<unsigned int>("curl","low-speed-time",30).get();
+
 	}
 
 	HTTP::Handler::~Handler() {
@@ -65,6 +72,67 @@
 		return url.c_str();
 	}
 
+	/// @brief Get static copy of well-known header names.
+	static const char * intern(const char *name, size_t length) noexcept {
+
+		static const char * names[] = {
+			"Accept",
+			"Accept-Encoding",
+			"Accept-Ranges",
+			"Age",
+			"Authorization",
+			"Cache-Control",
+			"Connection",
+			"Content-Disposition",
+			"Content-Encoding",
+			"Content-Language",
+			"Content-Length",
+			"Content-Location",
+			"Content-MD5",
+			"Content-Range",
+			"Content-Type",
+			"Date",
+			"Digest",
+			"ETag",
+			"Expires",
+			"Host",
+			"Keep-Alive",
+			"Last-Modified",
+			"Location",
+			"Pragma",
+			"Repr-Digest",
+			"Server",
+			"Set-Cookie",
+			"Strict-Transport-Security",
+			"Transfer-Encoding",
+			"User-Agent",
+			"Vary",
+			"Via",
+			"WWW-Authenticate",
+			"X-Content-Type-Options",
+			"X-Frame-Options",
+		};
+
+		for(const char *str : names) {
+			if(strncasecmp(str,name,length) == 0 && !str[length]) {
+				return str;
+			}
+		}
+
+		return nullptr;
+
+	}
+
+	HTTP::Handler::Header::Header(const char *n, const char *v) : Header{n,strlen(n),v,strlen(v)} {
+	}
+
+	HTTP::Handler::Header::Header(const char *n, size_t nl, const char *v, size_t vl) 
+		: interned{intern(n,nl)}, value{v,vl} {
+		if(!interned) {
+			custom.assign(n,nl);
+		}
+	}
+
 	URL::Handler & HTTP::Handler::header(const char *name, const char *value) {
 		headers.request.emplace_back(name,value);
 		return *this;
@@ -73,17 +141,48 @@
 	const char * HTTP::Handler::header(const char *name) const {
 
 		for(const auto &header : headers.response) {
-			if(strcasecmp(header.name.c_str(),name) == 0) {
+			if(strcasecmp(header.name(),name) == 0) {
 				return header.value.c_str();
 			}
 		}
 
 		return "";
 	}
+
+	HTTP::Handler & HTTP::Handler::progress(const std::function<bool(uint64_t current, uint64_t total)> &callback, unsigned int interval, uint64_t step) {
+
+		notify.callback = callback;
+		notify.interval = (interval ? interval : Config::Value<unsigned int>("http","progress-interval",250).get());
+		notify.step = (step ? step : Config::Value<unsigned long>("http","progress-step",1048576).get());
+
+		return *this;
+	}
+
+	HTTP::Handler & HTTP::Handler::verify(const char *algorithm, const char *expected) {
+
+#ifdef HAVE_LIBCRYPTO
+		digests.push_back(Digest{algorithm,expected ? expected : "",""});
+		return *this;
+#else
+		throw system_error(ENOTSUP,system_category(),"Response digests requires libcrypto");
+#endif // HAVE_LIBCRYPTO
+
+	}
+
+	const char * HTTP::Handler::digest(const char *algorithm) const noexcept {
+
+		for(const auto &digest : digests) {
+			if(strcasecmp(digest.algorithm.c_str(),algorithm) == 0) {
+				return digest.value.c_str();
+			}
+		}
+
+		return "";
+	}
 	
 #if defined(HAVE_JSON_C)
 
-	static void load(Udjat::Value &value, struct json_object *jobj) {
+	void HTTP::load(Udjat::Value &value, struct json_object *jobj) {
 
 		switch(json_object_get_type(jobj)) {
 		case json_type_null:
@@ -167,19 +266,66 @@
 
 	}
 
-	int HTTP::Handler::test(const HTTP::Method method, const char *payload) {
-		return Context{
-			*this,
-			[](uint64_t,uint64_t,const void *,size_t){return false;}
-		}.test(method,payload);
+	int HTTP::Handler::transfer(const std::function<int(Context &context)> &call) {
+
+		std::unique_lock<std::mutex> lock{cache.guard,std::try_to_lock};
+
+		if(!lock.owns_lock()) {
+			// The cached context is in use by another thread.
+			Context context{*this};
+			return call(context);
+		}
+
+		if(cache.context) {
+			cache.context->configure();
+		} else {
+			cache.context.reset(new Context{*this});
+		}
+
+		return call(*cache.context);
 
 	}
+
+	int HTTP::Handler::test(const HTTP::Method method, const char *payload) {
+		static const std::function<bool(uint64_t current, uint64_t total, const void *data, size_t len)> discard = [](uint64_t,uint64_t,const void *,size_t){return false;};
+		return transfer([&](Context &context){
+			return context.bind(discard).test(method,payload);
+		});
+	}
                                                                                  
+	int HTTP::Handler::test(const HTTP::Method method, const char *payload, const std::function<bool(uint64_t current, uint64_t total, const void *data, size_t len)> &writer) {
+		return transfer([&](Context &context){
+			return context.bind(writer).test(method,payload,true);
+		});
+	}
+
 	int HTTP::Handler::perform(const HTTP::Method method, const char *payload, const std::function<bool(uint64_t current, uint64_t total, const void *data, size_t len)> &progress) {
-		return Context{
-			*this,
-			progress
-		}.perform(method,payload);
+		return transfer([&](Context &context){
+			return context.bind(progress).perform(method,payload);
+		});
+	}
+
+	int HTTP::Handler::perform(const HTTP::Method method, const char *payload, HTTP::Sink &sink) {
+
+		try {
+
+			return transfer([&](Context &context){
+				return context.bind(sink).perform(method,payload);
+			});
+
+		} catch(const std::system_error &e) {
+
+			// Failed before (or while) starting the transfer, don't leave the consumer waiting.
+			sink.abort(e.code().value());
+			throw;
+
+		} catch(...) {
+
+			sink.abort(EIO);
+			throw;
+
+		}
+
 	}
 
 #if defined(HAVE_CURL)
@@ -0,0 +1,145 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements lock-free latency histogram.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/histogram.h>
+ #include <algorithm>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	HTTP::Histogram::Histogram(time_t window) : length{window >= (time_t) slots ? (time_t) (window/slots) : 1} {
+		for(auto &s : slot) {
+			for(auto &count : s.counts) {
+				count.store(0,std::memory_order_relaxed);
+			}
+		}
+	}
+
+	size_t HTTP::Histogram::index(uint64_t value) noexcept {
+
+		if(value < 16) {
+			return (size_t) value;
+		}
+
+		// Magnitude and the next 3 bits.
+		size_t magnitude = 63 - __builtin_clzll(value);
+		size_t ix = 16 + ((magnitude - 4) * 8) + ((value >> (magnitude - 3)) & 7);
+
+		return ix < buckets ? ix : buckets-1;
+
+	}
+
+	uint64_t HTTP::Histogram::upper(size_t ix) noexcept {
+
+		if(ix < 16) {
+			return ix;
+		}
+
+		size_t magnitude = ((ix - 16) / 8) + 4;
+		uint64_t sub = (ix - 16) % 8;
+
+		return ((8 + sub + 1) << (magnitude - 3)) - 1;
+
+	}
+
+	void HTTP::Histogram::record(uint64_t value) noexcept {
+
+		time_t epoch = time(0) / length;
+		Slot &s = slot[epoch % slots];
+
+		time_t current = s.epoch.load(std::memory_order_acquire);
+		if(current != epoch && s.epoch.compare_exchange_strong(current,epoch,std::memory_order_acq_rel)) {
+			// Slot is from an old window, reuse it.
+			for(auto &count : s.counts) {
+				count.store(0,std::memory_order_relaxed);
+			}
+			s.max.store(0,std::memory_order_relaxed);
+		}
+
+		s.counts[index(value)].fetch_add(1,std::memory_order_relaxed);
+
+		uint64_t max = s.max.load(std::memory_order_relaxed);
+		while(value > max && !s.max.compare_exchange_weak(max,value,std::memory_order_relaxed));
+
+	}
+
+	HTTP::Histogram::Summary HTTP::Histogram::summary() const noexcept {
+
+		Summary summary;
+		uint64_t counts[buckets] = {0};
+
+		time_t epoch = time(0) / length;
+
+		for(const auto &s : slot) {
+
+			time_t e = s.epoch.load(std::memory_order_acquire);
+			if(!e || e + (time_t) slots <= epoch) {
+				// Outside of the window.
+				continue;
+			}
+
+			for(size_t ix = 0; ix < buckets; ix++) {
+				uint32_t count = s.counts[ix].load(std::memory_order_relaxed);
+				counts[ix] += count;
+				summary.count += count;
+			}
+
+			uint64_t max = s.max.load(std::memory_order_relaxed);
+			if(max > summary.max) {
+				summary.max = max;
+			}
+
+		}
+
+		if(!summary.count) {
+			return summary;
+		}
+
+		struct {
+			double quantile;
+			uint64_t *value;
+		} targets[] = {
+			{ 0.50, &summary.p50 },
+			{ 0.90, &summary.p90 },
+			{ 0.99, &summary.p99 },
+		};
+
+		uint64_t total = 0;
+		size_t target = 0;
+		for(size_t ix = 0; ix < buckets && target < (sizeof(targets)/sizeof(targets[0])); ix++) {
+			total += counts[ix];
+			while(target < (sizeof(targets)/sizeof(targets[0])) && total >= (uint64_t) (targets[target].quantile * summary.count + 0.5)) {
+				// Bucket limit, but never above the real maximum.
+				*targets[target].value = std::min(upper(ix),summary.max);
+				target++;
+			}
+		}
+
+		return summary;
+
+	}
+
+ }
@@ -0,0 +1,296 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements incremental JSON parser.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/json.h>
+ #include <stdexcept>
+ #include <cctype>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	HTTP::JsonParser::JsonParser(const Handler &h) : handler{h} {
+	}
+
+	void HTTP::JsonParser::reset() {
+		state = Value;
+		stack.clear();
+		pointer.clear();
+		token.clear();
+		key = false;
+		stopped = false;
+	}
+
+	void HTTP::JsonParser::element() {
+		auto &container = stack.back();
+		pointer.resize(container.length);
+		pointer += '/';
+		pointer += std::to_string(container.index++);
+	}
+
+	void HTTP::JsonParser::complete() {
+		state = stack.empty() ? Complete : Next;
+	}
+
+	bool HTTP::JsonParser::scalar(Event event) {
+		bool rc = handler(event,pointer,token);
+		token.clear();
+		complete();
+		return rc;
+	}
+
+	bool HTTP::JsonParser::literal() {
+
+		if(token == "true" || token == "false") {
+			return scalar(Boolean);
+		}
+
+		if(token == "null") {
+			return scalar(Null);
+		}
+
+		char *end = nullptr;
+		strtod(token.c_str(),&end);
+		if(token.empty() || !end || *end) {
+			throw runtime_error(string{"Invalid JSON value '"} + token + "'");
+		}
+
+		return scalar(Number);
+
+	}
+
+	void HTTP::JsonParser::append(unsigned int cp) {
+
+		if(cp < 0x80) {
+			token += (char) cp;
+		} else if(cp < 0x800) {
+			token += (char) (0xC0 | (cp >> 6));
+			token += (char) (0x80 | (cp & 0x3F));
+		} else if(cp < 0x10000) {
+			token += (char) (0xE0 | (cp >> 12));
+			token += (char) (0x80 | ((cp >> 6) & 0x3F));
+			token += (char) (0x80 | (cp & 0x3F));
+		} else {
+			token += (char) (0xF0 | (cp >> 18));
+			token += (char) (0x80 | ((cp >> 12) & 0x3F));
+			token += (char) (0x80 | ((cp >> 6) & 0x3F));
+			token += (char) (0x80 | (cp & 0x3F));
+		}
+
+	}
+
+	bool HTTP::JsonParser::parse(const char *data, size_t length) {
+
+		for(size_t ix = 0; ix < length && !stopped; ix++) {
+
+			char chr = data[ix];
+
+			switch(state) {
+			case Text:
+				if(chr == '\\') {
+					state = Escape;
+				} else if(chr == '"') {
+					if(key) {
+						// Got object key, update pointer (RFC 6901 escapes).
+						key = false;
+						pointer.resize(stack.back().length);
+						pointer += '/';
+						for(char c : token) {
+							if(c == '~') {
+								pointer += "~0";
+							} else if(c == '/') {
+								pointer += "~1";
+							} else {
+								pointer += c;
+							}
+						}
+						token.clear();
+						state = Colon;
+					} else {
+						stopped = scalar(String);
+					}
+				} else {
+					token += chr;
+				}
+				break;
+
+			case Escape:
+				state = Text;
+				switch(chr) {
+				case 'b':
+					token += '\b';
+					break;
+				case 'f':
+					token += '\f';
+					break;
+				case 'n':
+					token += '\n';
+					break;
+				case 'r':
+					token += '\r';
+					break;
+				case 't':
+					token += '\t';
+					break;
+				case 'u':
+					codepoint = 0;
+					digits = 0;
+					state = Unicode;
+					break;
+				default:
+					token += chr;
+				}
+				break;
+
+			case Unicode:
+				if(!isxdigit((unsigned char) chr)) {
+					throw runtime_error("Invalid JSON unicode escape");
+				}
+				codepoint = (codepoint << 4) | (unsigned int) (isdigit((unsigned char) chr) ? chr - '0' : (tolower((unsigned char) chr) - 'a' + 10));
+				if(++digits == 4) {
+					state = Text;
+					if(codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+						surrogate = codepoint;
+					} else if(codepoint >= 0xDC00 && codepoint <= 0xDFFF && surrogate) {
+						append(0x10000 + ((surrogate - 0xD800) << 10) + (codepoint - 0xDC00));
+						surrogate = 0;
+					} else {
+						append(codepoint);
+					}
+				}
+				break;
+
+			case Literal:
+				if(isalnum((unsigned char) chr) || chr == '-' || chr == '+' || chr == '.') {
+					token += chr;
+					break;
+				}
+				stopped = literal();
+				if(stopped) {
+					break;
+				}
+				ix--;	// Process the delimiter.
+				break;
+
+			default:
+
+				if(isspace((unsigned char) chr)) {
+					break;
+				}
+
+				switch(state) {
+				case Value:
+					if(!stack.empty() && stack.back().array) {
+						if(chr == ']' && !stack.back().index) {
+							// Empty array.
+							pointer.resize(stack.back().length);
+							stack.pop_back();
+							stopped = handler(End,pointer,token);
+							complete();
+							break;
+						}
+						element();
+					}
+
+					if(chr == '{' || chr == '[') {
+						bool array = (chr == '[');
+						stopped = handler(array ? Array : Object,pointer,token);
+						stack.emplace_back(array,pointer.size());
+						state = array ? Value : FirstKey;
+					} else if(chr == '"') {
+						state = Text;
+					} else {
+						token += chr;
+						state = Literal;
+					}
+					break;
+
+				case FirstKey:
+				case Key:
+					if(chr == '"') {
+						key = true;
+						state = Text;
+					} else if(chr == '}' && state == FirstKey) {
+						pointer.resize(stack.back().length);
+						stack.pop_back();
+						stopped = handler(End,pointer,token);
+						complete();
+					} else {
+						throw runtime_error("Invalid JSON, expecting object key");
+					}
+					break;
+
+				case Colon:
+					if(chr != ':') {
+						throw runtime_error("Invalid JSON, expecting ':'");
+					}
+					state = Value;
+					break;
+
+				case Next:
+					if(chr == ',') {
+						state = stack.back().array ? Value : Key;
+					} else if(chr == (stack.back().array ? ']' : '}')) {
+						pointer.resize(stack.back().length);
+						stack.pop_back();
+						stopped = handler(End,pointer,token);
+						complete();
+					} else {
+						throw runtime_error("Invalid JSON, expecting ',' or end of container");
+					}
+					break;
+
+				case Complete:
+					throw runtime_error("Unexpected data after the JSON document");
+
+				default:
+					break;
+				}
+
+			}
+
+		}
+
+		return stopped;
+
+	}
+
+	void HTTP::JsonParser::finish() {
+
+		if(stopped) {
+			return;
+		}
+
+		if(state == Literal && stack.empty()) {
+			stopped = literal();
+		}
+
+		if(state != Complete) {
+			throw runtime_error("Incomplete JSON document");
+		}
+
+	}
+
+ }
@@ -0,0 +1,190 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements streaming response body assertions.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/matcher.h>
+ #include <udjat/tools/configuration.h>
+ #include <udjat/tools/logger.h>
+ #include <algorithm>
+ #include <system_error>
+ #include <errno.h>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	HTTP::BodyMatcher::BodyMatcher(const XML::Node &node) 
+		: limit{node.attribute("body-matches-window").as_uint(Config::Value<unsigned int>("http","body-matches-window",4096).get())},
+			parser{[this](JsonParser::Event event, const std::string &pointer, const std::string &value){
+
+				if(pointer != json.pointer) {
+					return false;
+				}
+
+				if(event == JsonParser::Object || event == JsonParser::Array) {
+					json.result = Failed;
+				} else {
+					json.result = (value == json.value ? Passed : Failed);
+				}
+
+				return true;
+
+			}} {
+
+		contains.text = node.attribute("body-contains").as_string();
+
+		const char *expression = node.attribute("body-matches").as_string();
+		if(*expression) {
+
+			// The regex executor recurses on the input, keep the searched bytes (up to twice the window) small.
+			if(!limit || limit > 8192) {
+				throw system_error(EINVAL,system_category(),"The body-matches-window should be between 1 and 8192 bytes");
+			}
+
+			matches.expression.reset(new std::regex{expression,std::regex::ECMAScript|std::regex::nosubs});
+		}
+
+		json.pointer = node.attribute("json-pointer").as_string();
+		json.value = node.attribute("json-value").as_string();
+
+	}
+
+	void HTTP::BodyMatcher::reset() {
+
+		window.clear();
+		searched = 0;
+		parser.reset();
+
+		contains.result = (contains.text.empty() ? Passed : Pending);
+		matches.result = (matches.expression ? Pending : Passed);
+		json.result = (json.pointer.empty() ? Passed : Pending);
+
+	}
+
+	HTTP::BodyMatcher::Result HTTP::BodyMatcher::result() const noexcept {
+
+		if(contains.result == Failed || matches.result == Failed || json.result == Failed) {
+			return Failed;
+		}
+
+		if(contains.result == Passed && matches.result == Passed && json.result == Passed) {
+			return Passed;
+		}
+
+		return Pending;
+
+	}
+
+	bool HTTP::BodyMatcher::write(const void *data, size_t length) {
+
+		if(contains.result == Pending || matches.result == Pending) {
+
+			size_t from = window.size();
+			window.append((const char *) data,length);
+
+			// Only the new bytes and the ones a match can start on.
+			if(contains.result == Pending) {
+				size_t overlap = contains.text.size() - 1;
+				if(window.find(contains.text,(from > overlap ? from - overlap : 0)) != string::npos) {
+					contains.result = Passed;
+				}
+			}
+
+			// The expression runs once every 'limit' bytes (and at the end of the body), keeping the cost linear on the body length.
+			if(matches.result == Pending && window.size() - searched >= limit) {
+				search();
+			}
+
+			trim();
+
+		}
+
+		if(json.result == Pending) {
+
+			try {
+
+				parser.parse((const char *) data,length);
+				if(json.result == Pending && parser.done()) {
+					json.result = Failed;
+				}
+
+			} catch(const std::exception &e) {
+
+				Logger::String{"Cant parse response body: ",e.what()}.trace("http");
+				json.result = Failed;
+
+			}
+
+		}
+
+		return result() != Pending;
+
+	}
+
+	void HTTP::BodyMatcher::search() {
+
+		// Matches ending on the new bytes can start up to 'limit' bytes before them.
+		size_t begin = (searched > limit ? searched - limit : 0);
+
+		if(std::regex_search(
+				window.cbegin() + begin,
+				window.cend(),
+				*matches.expression,
+				(begin ? std::regex_constants::match_prev_avail : std::regex_constants::match_default)
+			)) {
+			matches.result = Passed;
+		}
+
+		searched = window.size();
+
+	}
+
+	void HTTP::BodyMatcher::trim() {
+
+		size_t keep = 0;
+
+		if(contains.result == Pending) {
+			keep = contains.text.size() - 1;
+		}
+
+		if(matches.result == Pending) {
+			keep = std::max(keep,window.size() - searched + limit);
+		}
+
+		if(window.size() > keep) {
+			size_t length = window.size() - keep;
+			window.erase(0,length);
+			searched = (searched > length ? searched - length : 0);
+		}
+
+	}
+
+	bool HTTP::BodyMatcher::finish() {
+		if(matches.result == Pending && window.size() > searched) {
+			search();
+		}
+		return result() == Passed;
+	}
+
+ }
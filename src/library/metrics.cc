@@ -0,0 +1,327 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements per-host transfer metrics.
+  *
+  * Every thread counts on its own table, the writer is the only thread
+  * updating a counter so there are no atomic read-modify-write operations on
+  * the transfer path; readers merge the tables of the live threads with the
+  * totals left by the finished ones.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <udjat/tools/http/metrics.h>
+ #include <udjat/tools/configuration.h>
+ #include <udjat/tools/value.h>
+ #include <atomic>
+ #include <memory>
+ #include <mutex>
+ #include <unordered_map>
+ #include <algorithm>
+ #include <cstdio>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	constexpr uint64_t HTTP::Metrics::bounds[];
+
+	namespace {
+
+		/// @brief Counters of one host on one thread.
+		struct Counters {
+			atomic<uint64_t> requests{0};
+			atomic<uint64_t> failed{0};
+			atomic<uint64_t> sent{0};
+			atomic<uint64_t> received{0};
+			atomic<uint64_t> time{0};
+			atomic<uint64_t> status[6] = {};
+			atomic<uint64_t> latency[HTTP::Metrics::Buckets] = {};
+			atomic<uint64_t> errors[HTTP::Metrics::Errors] = {};
+
+			/// @brief Add to counter, only the owner thread writes.
+			static inline void add(atomic<uint64_t> &counter, uint64_t value) noexcept {
+				counter.store(counter.load(memory_order_relaxed) + value, memory_order_relaxed);
+			}
+
+			/// @brief Add counters to host totals.
+			void merge(HTTP::Metrics::Host &host) const noexcept {
+				host.requests += requests.load(memory_order_relaxed);
+				host.failed += failed.load(memory_order_relaxed);
+				host.sent += sent.load(memory_order_relaxed);
+				host.received += received.load(memory_order_relaxed);
+				host.time += time.load(memory_order_relaxed);
+				for(size_t ix = 0; ix < 6; ix++) {
+					host.status[ix] += status[ix].load(memory_order_relaxed);
+				}
+				for(size_t ix = 0; ix < HTTP::Metrics::Buckets; ix++) {
+					host.latency[ix] += latency[ix].load(memory_order_relaxed);
+				}
+				for(size_t ix = 0; ix < HTTP::Metrics::Errors; ix++) {
+					uint64_t count = errors[ix].load(memory_order_relaxed);
+					if(count) {
+						host.errors[(int) ix] += count;
+					}
+				}
+			}
+
+		};
+
+		class Shard;
+
+		/// @brief The per-thread tables and the totals of the finished threads.
+		struct Registry {
+
+			/// @brief Protects the shard list, the table structure and the retired totals.
+			mutex guard;
+
+			vector<Shard *> shards;
+			map<string,HTTP::Metrics::Host> retired;
+
+			static Registry & instance() {
+				static Registry registry;
+				return registry;
+			}
+
+		};
+
+		/// @brief Counters of one thread.
+		class Shard {
+		private:
+			unordered_map<string,unique_ptr<Counters>> table;
+
+		public:
+			Shard() {
+				Registry &registry = Registry::instance();
+				lock_guard<mutex> lock{registry.guard};
+				registry.shards.push_back(this);
+			}
+
+			~Shard() {
+				Registry &registry = Registry::instance();
+				lock_guard<mutex> lock{registry.guard};
+				merge(registry.retired);
+				registry.shards.erase(std::remove(registry.shards.begin(),registry.shards.end(),this),registry.shards.end());
+			}
+
+			/// @brief Get counters for host, the table is only changed by the owner thread.
+			Counters & get(const string &host) {
+
+				auto it = table.find(host);
+				if(it != table.end()) {
+					return *it->second;
+				}
+
+				unique_ptr<Counters> counters{new Counters()};
+				Counters &rc = *counters;
+
+				Registry &registry = Registry::instance();
+				lock_guard<mutex> lock{registry.guard};
+				table.emplace(host,std::move(counters));
+
+				return rc;
+			}
+
+			/// @brief Add counters to totals, the registry must be locked.
+			void merge(map<string,HTTP::Metrics::Host> &hosts) const {
+				for(const auto &entry : table) {
+					HTTP::Metrics::Host &host = hosts[entry.first];
+					host.name = entry.first;
+					entry.second->merge(host);
+				}
+			}
+
+		};
+
+	}
+
+	void HTTP::Metrics::record(const std::string &host, int error, int status, uint64_t sent, uint64_t received, uint64_t time) noexcept {
+
+		static const bool enabled = Config::Value<bool>("http","metrics",true).get();
+		if(!enabled || host.empty()) {
+			return;
+		}
+
+		try {
+
+			thread_local Shard shard;
+			Counters &counters = shard.get(host);
+
+			Counters::add(counters.requests,1);
+			Counters::add(counters.sent,sent);
+			Counters::add(counters.received,received);
+			Counters::add(counters.time,time);
+
+			if(error) {
+				Counters::add(counters.failed,1);
+				Counters::add(counters.errors[std::min((size_t) std::max(error,0),Errors-1)],1);
+			}
+
+			Counters::add(counters.status[(status >= 100 && status < 600) ? (status / 100) : 0],1);
+
+			size_t bucket = std::upper_bound(bounds,bounds+Buckets-1,time-1) - bounds;
+			Counters::add(counters.latency[time ? bucket : 0],1);
+
+		} catch(...) {
+
+			// Out of memory on a new host, the transfer is not counted.
+
+		}
+
+	}
+
+	std::vector<HTTP::Metrics::Host> HTTP::Metrics::hosts() {
+
+		Registry &registry = Registry::instance();
+		map<string,Host> totals;
+
+		{
+			lock_guard<mutex> lock{registry.guard};
+			totals = registry.retired;
+			for(const Shard *shard : registry.shards) {
+				shard->merge(totals);
+			}
+		}
+
+		std::vector<Host> hosts;
+		hosts.reserve(totals.size());
+		for(auto &entry : totals) {
+			hosts.push_back(std::move(entry.second));
+		}
+
+		return hosts;
+
+	}
+
+	Udjat::Value & HTTP::Metrics::get(Udjat::Value &value) {
+
+		value.set(Value::Object);
+
+		for(const auto &host : hosts()) {
+
+			Value &item = value[host.name.c_str()];
+
+			item["requests"] = (unsigned int) host.requests;
+			item["failed"] = (unsigned int) host.failed;
+			item["sent"] = (double) host.sent;
+			item["received"] = (double) host.received;
+			item["time"] = ((double) host.time) / 1000.0;		// Milliseconds, as the agent timings.
+
+			static const char *classes[] = { "status-none", "status-1xx", "status-2xx", "status-3xx", "status-4xx", "status-5xx" };
+			for(size_t ix = 0; ix < 6; ix++) {
+				item[classes[ix]] = (unsigned int) host.status[ix];
+			}
+
+			Value &errors = item["errors"];
+			errors.set(Value::Object);
+			for(const auto &error : host.errors) {
+				errors[std::to_string(error.first).c_str()] = (unsigned int) error.second;
+			}
+
+		}
+
+		return value;
+
+	}
+
+	/// @brief Escape Prometheus label value.
+	static std::string label(const std::string &value) {
+		std::string rc;
+		rc.reserve(value.size());
+		for(char chr : value) {
+			switch(chr) {
+			case '\\':
+				rc += "\\\\";
+				break;
+			case '"':
+				rc += "\\\"";
+				break;
+			case '\n':
+				rc += "\\n";
+				break;
+			default:
+				rc += chr;
+			}
+		}
+		return rc;
+	}
+
+	std::string HTTP::Metrics::prometheus() {
+
+		auto hosts = HTTP::Metrics::hosts();
+		std::string text;
+		char buffer[512];
+
+		auto counter = [&](const char *name, const char *help, uint64_t Host::*field) {
+			text += std::string{"# HELP "} + name + " " + help + "\n# TYPE " + name + " counter\n";
+			for(const auto &host : hosts) {
+				snprintf(buffer,sizeof(buffer),"%s{host=\"%s\"} %llu\n",name,label(host.name).c_str(),(unsigned long long) (host.*field));
+				text += buffer;
+			}
+		};
+
+		counter("udjat_http_requests_total","HTTP transfers by host.",&Host::requests);
+		counter("udjat_http_failures_total","HTTP transfers finished with error by host.",&Host::failed);
+		counter("udjat_http_sent_bytes_total","Bytes sent by host.",&Host::sent);
+		counter("udjat_http_received_bytes_total","Bytes received by host.",&Host::received);
+
+		text += "# HELP udjat_http_responses_total HTTP responses by host and status class.\n# TYPE udjat_http_responses_total counter\n";
+		for(const auto &host : hosts) {
+			for(size_t ix = 1; ix < 6; ix++) {
+				if(host.status[ix]) {
+					snprintf(buffer,sizeof(buffer),"udjat_http_responses_total{host=\"%s\",class=\"%uxx\"} %llu\n",label(host.name).c_str(),(unsigned int) ix,(unsigned long long) host.status[ix]);
+					text += buffer;
+				}
+			}
+		}
+
+		text += "# HELP udjat_http_errors_total HTTP transfers finished with error by host and engine error code.\n# TYPE udjat_http_errors_total counter\n";
+		for(const auto &host : hosts) {
+			for(const auto &error : host.errors) {
+				snprintf(buffer,sizeof(buffer),"udjat_http_errors_total{host=\"%s\",code=\"%d\"} %llu\n",label(host.name).c_str(),error.first,(unsigned long long) error.second);
+				text += buffer;
+			}
+		}
+
+		text += "# HELP udjat_http_request_duration_seconds HTTP transfer time by host.\n# TYPE udjat_http_request_duration_seconds histogram\n";
+		for(const auto &host : hosts) {
+			std::string name{label(host.name)};
+			uint64_t cumulative = 0;
+			for(size_t ix = 0; ix < Buckets; ix++) {
+				cumulative += host.latency[ix];
+				if(ix < Buckets-1) {
+					snprintf(buffer,sizeof(buffer),"udjat_http_request_duration_seconds_bucket{host=\"%s\",le=\"%g\"} %llu\n",name.c_str(),((double) bounds[ix]) / 1000000.0,(unsigned long long) cumulative);
+				} else {
+					snprintf(buffer,sizeof(buffer),"udjat_http_request_duration_seconds_bucket{host=\"%s\",le=\"+Inf\"} %llu\n",name.c_str(),(unsigned long long) cumulative);
+				}
+				text += buffer;
+			}
+			snprintf(buffer,sizeof(buffer),"udjat_http_request_duration_seconds_sum{host=\"%s\"} %.6f\n",name.c_str(),((double) host.time) / 1000000.0);
+			text += buffer;
+			snprintf(buffer,sizeof(buffer),"udjat_http_request_duration_seconds_count{host=\"%s\"} %llu\n",name.c_str(),(unsigned long long) host.requests);
+			text += buffer;
+		}
+
+		return text;
+
+	}
+
+ }
@@ -24,6 +24,10 @@
  #include <udjat/tools/url.h>
  #include <udjat/tools/url/handler/http.h>
  #include <udjat/module/http.h>
+ #include <udjat/tools/http/metrics.h>
+ #include <private/trace.h>
+ #include <udjat/tools/value.h>
+ #include <cstring>
 
  #if defined(HAVE_CURL)
 	#include <curl/curl.h>
@@ -73,5 +77,23 @@
 	HTTP::Module::~Module() {
 	}
 
+	Value & HTTP::Module::getProperties(Value &properties) const {
+		Udjat::Module::getProperties(properties);
+		HTTP::Metrics::get(properties["hosts"]);
+		return properties;
+	}
+
+	bool HTTP::Module::getProperty(const char *key, std::string &value) const {
+		if(!strcasecmp(key,"metrics")) {
+			value = HTTP::Metrics::prometheus();
+			return true;
+		}
+		if(!strcasecmp(key,"trace")) {
+			value = HTTP::Trace::dump();
+			return true;
+		}
+		return Udjat::Module::getProperty(key,value);
+	}
+
  }
 
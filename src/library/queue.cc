@@ -0,0 +1,284 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements bounded delivery queue for asynchronous actions.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/queue.h>
+ #include <udjat/tools/logger.h>
+ #include <cstring>
+ #include <chrono>
+ #include <system_error>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	static size_t round_capacity(size_t capacity) noexcept {
+		size_t value = 2;
+		while(value < capacity) {
+			value <<= 1;
+		}
+		return value;
+	}
+
+	HTTP::Queue::Overflow HTTP::Queue::OverflowFactory(const char *name) {
+
+		static const struct {
+			const char *name;
+			Overflow value;
+		} policies[] = {
+			{ "drop-oldest",	DropOldest	},
+			{ "drop-newest",	DropNewest	},
+			{ "block",			Block		},
+		};
+
+		for(const auto &policy : policies) {
+			if(strcasecmp(name,policy.name) == 0) {
+				return policy.value;
+			}
+		}
+
+		throw system_error(EINVAL,system_category(),Logger::String{"Unexpected overflow policy '",name,"'"});
+
+	}
+
+	HTTP::Queue::Queue(size_t capacity, unsigned int count, Overflow o, const std::function<bool(const std::string &payload)> &d)
+		: cells{new Cell[round_capacity(capacity)]}, mask{round_capacity(capacity)-1}, overflow{o}, deliver{d} {
+
+		for(size_t ix = 0; ix <= mask; ix++) {
+			cells[ix].sequence.store(ix,std::memory_order_relaxed);
+		}
+
+		if(!count) {
+			count = 1;
+		}
+
+		for(unsigned int ix = 0; ix < count; ix++) {
+			workers.emplace_back([this](){
+
+				std::string payload;
+
+				for(;;) {
+
+					// Empty payloads are valid (GET actions), only pop() tells if an item was taken.
+					if(!pop(payload)) {
+						if(!enabled.load()) {
+							break;
+						}
+						wait();
+						continue;
+					}
+
+					// Slot released, wake up blocked producers.
+					wake();
+
+					try {
+
+						if(deliver(payload)) {
+							counters.delivered++;
+						} else {
+							counters.failed++;
+						}
+
+					} catch(const std::exception &e) {
+
+						counters.failed++;
+						Logger::String{e.what()}.error("http");
+
+					}
+
+					payload.clear();
+
+				}
+
+			});
+		}
+
+	}
+
+	HTTP::Queue::~Queue() {
+
+		enabled.store(false);
+		{
+			std::lock_guard<std::mutex> lock{idle.guard};
+			idle.cond.notify_all();
+		}
+
+		for(auto &worker : workers) {
+			worker.join();
+		}
+
+	}
+
+	bool HTTP::Queue::push(std::string &payload) noexcept {
+
+		size_t pos = head.load(std::memory_order_relaxed);
+		Cell *cell;
+
+		for(;;) {
+
+			cell = &cells[pos & mask];
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+
+			if(diff == 0) {
+				if(head.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed)) {
+					break;
+				}
+			} else if(diff < 0) {
+				// Full.
+				return false;
+			} else {
+				pos = head.load(std::memory_order_relaxed);
+			}
+
+		}
+
+		cell->payload.swap(payload);
+		cell->sequence.store(pos+1,std::memory_order_release);
+
+		return true;
+
+	}
+
+	bool HTTP::Queue::pop(std::string &payload) noexcept {
+
+		size_t pos = tail.load(std::memory_order_relaxed);
+		Cell *cell;
+
+		for(;;) {
+
+			cell = &cells[pos & mask];
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t) sequence - (intptr_t) (pos+1);
+
+			if(diff == 0) {
+				if(tail.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed)) {
+					break;
+				}
+			} else if(diff < 0) {
+				// Empty.
+				return false;
+			} else {
+				pos = tail.load(std::memory_order_relaxed);
+			}
+
+		}
+
+		payload.swap(cell->payload);
+		cell->payload.clear();
+		cell->sequence.store(pos+mask+1,std::memory_order_release);
+
+		return true;
+
+	}
+
+	void HTTP::Queue::wake() noexcept {
+		if(idle.waiting.load()) {
+			std::lock_guard<std::mutex> lock{idle.guard};
+			idle.cond.notify_all();
+		}
+	}
+
+	void HTTP::Queue::wait() noexcept {
+
+		std::unique_lock<std::mutex> lock{idle.guard};
+
+		size_t pos = head.load();
+		idle.waiting++;
+		idle.cond.wait_for(lock,std::chrono::seconds(1),[this,pos](){
+			return !enabled.load() || head.load() != pos || head.load() != tail.load();
+		});
+		idle.waiting--;
+
+	}
+
+	bool HTTP::Queue::enqueue(std::string &&payload) {
+
+		while(!push(payload)) {
+
+			switch(overflow) {
+			case DropNewest:
+				counters.dropped++;
+				return false;
+
+			case DropOldest:
+				{
+					std::string oldest;
+					if(pop(oldest)) {
+						counters.dropped++;
+					}
+				}
+				break;
+
+			case Block:
+				{
+					std::unique_lock<std::mutex> lock{idle.guard};
+					size_t pos = tail.load();
+					idle.waiting++;
+					idle.cond.wait_for(lock,std::chrono::milliseconds(100),[this,pos](){
+						return !enabled.load() || tail.load() != pos;
+					});
+					idle.waiting--;
+				}
+				if(!enabled.load()) {
+					counters.dropped++;
+					return false;
+				}
+				break;
+
+			}
+
+		}
+
+		counters.enqueued++;
+
+		size_t depth = head.load() - tail.load();
+		size_t peak = counters.peak.load(std::memory_order_relaxed);
+		while(depth > peak && !counters.peak.compare_exchange_weak(peak,depth,std::memory_order_relaxed));
+
+		wake();
+
+		return true;
+
+	}
+
+	HTTP::Queue::Metrics HTTP::Queue::metrics() const noexcept {
+
+		Metrics metrics;
+
+		size_t t = tail.load();
+		size_t h = head.load();
+
+		metrics.depth = (h > t ? h - t : 0);
+		metrics.peak = counters.peak.load();
+		metrics.enqueued = counters.enqueued.load();
+		metrics.dropped = counters.dropped.load();
+		metrics.delivered = counters.delivered.load();
+		metrics.failed = counters.failed.load();
+
+		return metrics;
+
+	}
+
+ }
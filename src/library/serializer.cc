@@ -0,0 +1,273 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements request serializers.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/serializer.h>
+ #include <udjat/tools/logger.h>
+ #include <cstring>
+ #include <cctype>
+ #include <system_error>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	HTTP::Serializer::Format HTTP::Serializer::FormatFactory(const char *name) {
+
+		static const struct {
+			const char *name;
+			Format format;
+		} formats[] = {
+			{ "json",					Json	},
+			{ "form",					Form	},
+			{ "x-www-form-urlencoded",	Form	},
+			{ "xml",					Xml		},
+		};
+
+		for(const auto &item : formats) {
+			if(strcasecmp(name,item.name) == 0) {
+				return item.format;
+			}
+		}
+
+		throw system_error(EINVAL,system_category(),Logger::String{"Unexpected payload format '",name,"'"});
+
+	}
+
+	HTTP::Serializer::Serializer(Format f, const Abstract::Object &o, const std::vector<std::string> &n)
+		: format{f}, object{o}, fields{n} {
+	}
+
+	const char * HTTP::Serializer::mimetype(Format format) noexcept {
+
+		switch(format) {
+		case Form:
+			return "application/x-www-form-urlencoded";
+
+		case Xml:
+			return "application/xml";
+
+		default:
+			return "application/json";
+		}
+
+	}
+
+	static void json_escape(std::string &chunk, const std::string &text) {
+
+		static const char *hex = "0123456789abcdef";
+
+		for(unsigned char chr : text) {
+			switch(chr) {
+			case '"':
+				chunk += "\\\"";
+				break;
+			case '\\':
+				chunk += "\\\\";
+				break;
+			case '\n':
+				chunk += "\\n";
+				break;
+			case '\r':
+				chunk += "\\r";
+				break;
+			case '\t':
+				chunk += "\\t";
+				break;
+			default:
+				if(chr < 0x20) {
+					chunk += "\\u00";
+					chunk += hex[chr >> 4];
+					chunk += hex[chr & 0x0f];
+				} else {
+					chunk += (char) chr;
+				}
+			}
+		}
+
+	}
+
+	static void form_escape(std::string &chunk, const std::string &text) {
+
+		static const char *hex = "0123456789ABCDEF";
+
+		for(unsigned char chr : text) {
+			if(isalnum(chr) || chr == '-' || chr == '_' || chr == '.' || chr == '~') {
+				chunk += (char) chr;
+			} else if(chr == ' ') {
+				chunk += '+';
+			} else {
+				chunk += '%';
+				chunk += hex[chr >> 4];
+				chunk += hex[chr & 0x0f];
+			}
+		}
+
+	}
+
+	static void xml_escape(std::string &chunk, const std::string &text) {
+
+		for(char chr : text) {
+			switch(chr) {
+			case '<':
+				chunk += "&lt;";
+				break;
+			case '>':
+				chunk += "&gt;";
+				break;
+			case '&':
+				chunk += "&amp;";
+				break;
+			case '"':
+				chunk += "&quot;";
+				break;
+			default:
+				chunk += chr;
+			}
+		}
+
+	}
+
+	static void xml_name(std::string &chunk, const std::string &name) {
+		for(char chr : name) {
+			chunk += ((isalnum((unsigned char) chr) || chr == '-' || chr == '_' || chr == '.') ? chr : '_');
+		}
+	}
+
+	bool HTTP::Serializer::next() {
+
+		chunk.clear();
+		offset = 0;
+
+		while(chunk.empty()) {
+
+			if(field > fields.size() + 1) {
+				return false;
+			}
+
+			if(field == 0) {
+
+				// Prefix
+				if(format == Json) {
+					chunk += '{';
+				} else if(format == Xml) {
+					chunk += "<?xml version=\"1.0\" encoding=\"UTF-8\"?><request>";
+				}
+
+			} else if(field == fields.size() + 1) {
+
+				// Suffix
+				if(format == Json) {
+					chunk += '}';
+				} else if(format == Xml) {
+					chunk += "</request>";
+				}
+
+			} else {
+
+				const std::string &name = fields[field-1];
+				std::string value;
+
+				if(object.getProperty(name.c_str(),value)) {
+
+					switch(format) {
+					case Json:
+						if(emitted) {
+							chunk += ',';
+						}
+						chunk += '"';
+						json_escape(chunk,name);
+						chunk += "\":\"";
+						json_escape(chunk,value);
+						chunk += '"';
+						break;
+
+					case Form:
+						if(emitted) {
+							chunk += '&';
+						}
+						form_escape(chunk,name);
+						chunk += '=';
+						form_escape(chunk,value);
+						break;
+
+					case Xml:
+						chunk += '<';
+						xml_name(chunk,name);
+						chunk += '>';
+						xml_escape(chunk,value);
+						chunk += "</";
+						xml_name(chunk,name);
+						chunk += '>';
+						break;
+					}
+
+					emitted++;
+
+				}
+
+			}
+
+			field++;
+
+		}
+
+		return true;
+
+	}
+
+	size_t HTTP::Serializer::read(char *buffer, size_t length) {
+
+		size_t written = 0;
+
+		while(written < length) {
+
+			if(offset >= chunk.size() && !next()) {
+				break;
+			}
+
+			size_t bytes = std::min(length - written, chunk.size() - offset);
+			memcpy(buffer+written,chunk.data()+offset,bytes);
+			offset += bytes;
+			written += bytes;
+
+		}
+
+		return written;
+
+	}
+
+	std::string HTTP::Serializer::str() {
+
+		std::string body;
+		while(next()) {
+			body += chunk;
+		}
+		offset = chunk.size();
+
+		return body;
+
+	}
+
+ }
@@ -0,0 +1,143 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements file descriptor based response sink.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <udjat/tools/http/sink.h>
+ #include <udjat/tools/logger.h>
+ #include <udjat/tools/string.h>
+ #include <system_error>
+ #include <atomic>
+ #include <fcntl.h>
+ #include <unistd.h>
+ #include <cstdio>
+ #include <cstdlib>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	HTTP::FileSink::FileSink(const char *dir) {
+
+#ifdef O_TMPFILE
+		fd = ::open(dir,O_TMPFILE|O_RDWR|O_CLOEXEC,0644);
+		if(fd >= 0) {
+			return;
+		}
+
+		if(errno != EOPNOTSUPP && errno != EISDIR && errno != EINVAL) {
+			throw system_error(errno,system_category(),String{"Cant create temporary file in ",dir});
+		}
+#endif // O_TMPFILE
+
+		// No O_TMPFILE support on the filesystem, use a hidden file; it can't be linked back, save() renames it.
+		name = String{dir,"/.udjat-http-XXXXXX"};
+		fd = mkstemp(&name[0]);
+		if(fd < 0) {
+			throw system_error(errno,system_category(),String{"Cant create temporary file in ",dir});
+		}
+
+	}
+
+	HTTP::FileSink::~FileSink() {
+		::close(fd);
+		if(!name.empty()) {
+			::unlink(name.c_str());
+		}
+	}
+
+	void HTTP::FileSink::allocate(uint64_t total) {
+
+		// Reserve space in advance, avoiding fragmentation; not an error if unsupported.
+		int rc = posix_fallocate(fd,0,(off_t) total);
+		if(rc && rc != EOPNOTSUPP && rc != EINVAL) {
+			throw system_error(rc,system_category(),"Cant allocate space for the response");
+		}
+
+	}
+
+	void HTTP::FileSink::write(uint64_t offset, const void *data, size_t len) {
+
+		const char *ptr = (const char *) data;
+
+		while(len) {
+			ssize_t bytes = pwrite(fd,ptr,len,(off_t) offset);
+			if(bytes < 0) {
+				if(errno == EINTR) {
+					continue;
+				}
+				throw system_error(errno,system_category(),"Cant write response to file");
+			}
+			ptr += bytes;
+			offset += bytes;
+			len -= bytes;
+		}
+
+		if(offset > length) {
+			length = offset;
+		}
+
+	}
+
+	void HTTP::FileSink::save(const char *filename) {
+
+		if(ftruncate(fd,(off_t) length)) {
+			throw system_error(errno,system_category(),"Cant set response file length");
+		}
+
+		if(!name.empty()) {
+
+			if(::rename(name.c_str(),filename)) {
+				throw system_error(errno,system_category(),String{"Cant save response to ",filename});
+			}
+			name.clear();
+			return;
+
+		}
+
+		char path[64];
+		snprintf(path,sizeof(path),"/proc/self/fd/%d",fd);
+
+		// Link to a temporary name on the target directory, the rename replaces an existing file atomically.
+		static std::atomic<unsigned int> serial{0};
+		std::string temporary;
+
+		for(;;) {
+			temporary = std::string{filename} + ".tmp-" + std::to_string(getpid()) + "-" + std::to_string(++serial);
+			if(!linkat(AT_FDCWD,path,AT_FDCWD,temporary.c_str(),AT_SYMLINK_FOLLOW)) {
+				break;
+			}
+			if(errno != EEXIST) {
+				throw system_error(errno,system_category(),String{"Cant save response to ",filename});
+			}
+		}
+
+		if(::rename(temporary.c_str(),filename)) {
+			int err = errno;
+			::unlink(temporary.c_str());
+			throw system_error(err,system_category(),String{"Cant save response to ",filename});
+		}
+
+	}
+
+ }
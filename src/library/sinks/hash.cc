@@ -0,0 +1,98 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements digest only response sink.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <udjat/tools/http/sink.h>
+ #include <udjat/tools/string.h>
+ #include <system_error>
+ #include <stdexcept>
+
+ #ifdef HAVE_LIBCRYPTO
+	#include <openssl/evp.h>
+ #endif // HAVE_LIBCRYPTO
+
+ using namespace std;
+
+ namespace Udjat {
+
+#ifdef HAVE_LIBCRYPTO
+
+	HTTP::HashSink::HashSink(const char *algorithm) : ctx{EVP_MD_CTX_new()} {
+
+		const EVP_MD *md = EVP_get_digestbyname(algorithm);
+		if(!md) {
+			EVP_MD_CTX_free((EVP_MD_CTX *) ctx);
+			throw system_error(ENOTSUP,system_category(),String{"Unsupported digest '",algorithm,"'"});
+		}
+
+		EVP_DigestInit_ex((EVP_MD_CTX *) ctx, md, NULL);
+
+	}
+
+	HTTP::HashSink::~HashSink() {
+		EVP_MD_CTX_free((EVP_MD_CTX *) ctx);
+	}
+
+	void HTTP::HashSink::write(uint64_t, const void *data, size_t length) {
+		if(!EVP_DigestUpdate((EVP_MD_CTX *) ctx, data, length)) {
+			throw runtime_error("Error updating response digest");
+		}
+	}
+
+	void HTTP::HashSink::finalize() {
+
+		unsigned char md[EVP_MAX_MD_SIZE];
+		unsigned int length = 0;
+
+		if(!EVP_DigestFinal_ex((EVP_MD_CTX *) ctx, md, &length)) {
+			throw runtime_error("Error finalizing response digest");
+		}
+
+		static const char *digits = "0123456789abcdef";
+		value.resize(length*2);
+		for(unsigned int ix = 0; ix < length; ix++) {
+			value[ix*2] = digits[md[ix] >> 4];
+			value[(ix*2)+1] = digits[md[ix] & 0x0F];
+		}
+
+	}
+
+#else
+
+	HTTP::HashSink::HashSink(const char *) : ctx{nullptr} {
+		throw system_error(ENOTSUP,system_category(),"Response digests requires libcrypto");
+	}
+
+	HTTP::HashSink::~HashSink() {
+	}
+
+	void HTTP::HashSink::write(uint64_t, const void *, size_t) {
+	}
+
+	void HTTP::HashSink::finalize() {
+	}
+
+#endif // HAVE_LIBCRYPTO
+
+ }
@@ -0,0 +1,154 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements memory based response sinks.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <udjat/tools/http/sink.h>
+ #include <cstring>
+ #include <system_error>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	HTTP::Sink::~Sink() {
+	}
+
+	void HTTP::Sink::allocate(uint64_t) {
+	}
+
+	void HTTP::Sink::finalize() {
+	}
+
+	void HTTP::Sink::abort(int) noexcept {
+	}
+
+	HTTP::RingBufferSink::RingBufferSink(size_t c) : buffer{new uint8_t[c]}, capacity{c} {
+	}
+
+	HTTP::RingBufferSink::~RingBufferSink() {
+		delete[] buffer;
+	}
+
+	void HTTP::RingBufferSink::write(uint64_t, const void *data, size_t length) {
+
+		const uint8_t *from = (const uint8_t *) data;
+
+		while(length) {
+
+			std::unique_lock<std::mutex> lock{guard};
+			cond.wait(lock,[this]{ return closed || used < capacity; });
+
+			if(closed) {
+				throw system_error(ECANCELED,system_category(),"The response consumer was closed");
+			}
+
+			// Copy up to the end of the ring or the free space, whatever comes first.
+			size_t tail = (head + used) % capacity;
+			size_t bytes = std::min(capacity - used, capacity - tail);
+			if(bytes > length) {
+				bytes = length;
+			}
+
+			memcpy(buffer+tail,from,bytes);
+			used += bytes;
+			from += bytes;
+			length -= bytes;
+
+			cond.notify_all();
+
+		}
+
+	}
+
+	void HTTP::RingBufferSink::finalize() {
+		std::lock_guard<std::mutex> lock{guard};
+		eof = true;
+		cond.notify_all();
+	}
+
+	void HTTP::RingBufferSink::abort(int code) noexcept {
+		std::lock_guard<std::mutex> lock{guard};
+		if(!error) {
+			error = (code ? code : EIO);
+		}
+		cond.notify_all();
+	}
+
+	size_t HTTP::RingBufferSink::read(void *data, size_t length) {
+
+		std::unique_lock<std::mutex> lock{guard};
+		cond.wait(lock,[this]{ return eof || closed || error || used; });
+
+		if(!used && error) {
+			throw system_error(error,system_category(),"The response transfer has failed");
+		}
+
+		size_t bytes = std::min(used, capacity - head);
+		if(bytes > length) {
+			bytes = length;
+		}
+
+		memcpy(data,buffer+head,bytes);
+		head = (head + bytes) % capacity;
+		used -= bytes;
+
+		cond.notify_all();
+
+		return bytes;
+
+	}
+
+	void HTTP::RingBufferSink::close() {
+		std::lock_guard<std::mutex> lock{guard};
+		closed = true;
+		cond.notify_all();
+	}
+
+	HTTP::MemorySink::MemorySink(void *r, size_t c) : region{(uint8_t *) r}, capacity{c}, allocated{false} {
+	}
+
+	HTTP::MemorySink::MemorySink(size_t c) : region{new uint8_t[c]}, capacity{c}, allocated{true} {
+	}
+
+	HTTP::MemorySink::~MemorySink() {
+		if(allocated) {
+			delete[] region;
+		}
+	}
+
+	void HTTP::MemorySink::write(uint64_t offset, const void *data, size_t len) {
+
+		if(offset + len > capacity) {
+			throw system_error(ENOSPC,system_category(),"Response is larger than the memory region");
+		}
+
+		memcpy(region+offset,data,len);
+
+		if(offset + len > length) {
+			length = offset + len;
+		}
+
+	}
+
+ }
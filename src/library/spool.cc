@@ -0,0 +1,532 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements persistent spool for failed deliveries.
+  *
+  * The spool is a directory of fixed size segments, named by a sequence number. Each segment is a
+  * list of records (header + payload, 8 byte aligned). The record is synced to disk before the
+  * header magic, which is synced last, so a torn write ends the segment. Delivered records are
+  * marked in place (without sync, a lost mark only repeats the delivery) and the segment is removed
+  * when all of its records are delivered. Damaged segments are renamed to '.bad' and skipped.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/spool.h>
+ #include <udjat/tools/logger.h>
+ #include <cstring>
+ #include <cinttypes>
+ #include <algorithm>
+ #include <chrono>
+ #include <system_error>
+
+#ifndef _WIN32
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <dirent.h>
+#endif // !_WIN32
+
+ using namespace std;
+
+ namespace Udjat {
+
+#ifdef _WIN32
+
+	HTTP::Spool::Spool(const char *p, const Limits &l, const std::function<bool(const std::string &payload)> &d)
+		: path{p}, limits{l}, deliver{d} {
+		throw system_error(ENOTSUP,system_category(),"The request spool is not available on this platform");
+	}
+
+	HTTP::Spool::~Spool() {
+	}
+
+	bool HTTP::Spool::empty() noexcept {
+		return true;
+	}
+
+	void HTTP::Spool::push(const std::string &) {
+		throw system_error(ENOTSUP,system_category(),"The request spool is not available on this platform");
+	}
+
+#else
+
+	namespace {
+
+		struct Record {
+			uint32_t magic;
+			uint32_t length;
+			uint32_t state;		///< @brief 0 = pending, 1 = delivered.
+			uint32_t reserved;
+		};
+
+		static constexpr uint32_t magic = 0x5444554a;
+
+		static inline size_t record_size(size_t length) noexcept {
+			return (sizeof(Record) + length + 7) & ~((size_t) 7);
+		}
+
+	}
+
+	class UDJAT_PRIVATE HTTP::Spool::Segment {
+	private:
+		int fd = -1;
+
+	public:
+		const uint64_t sequence;
+		uint8_t *data = nullptr;
+		size_t length = 0;
+		size_t used = 0;		///< @brief End of the valid records.
+		size_t read = 0;		///< @brief Reader position.
+
+		/// @brief Open segment file.
+		/// @param length The length of a new segment, 0 to open an existing one.
+		Segment(const std::string &filename, uint64_t s, size_t l) : sequence{s}, length{l} {
+
+			fd = ::open(filename.c_str(),(length ? (O_RDWR|O_CREAT|O_TRUNC) : O_RDWR)|O_CLOEXEC,0600);
+			if(fd < 0) {
+				throw system_error(errno,system_category(),filename);
+			}
+
+			if(length) {
+				// Allocate the blocks now, writing to a sparse mapping on a full disk raises SIGBUS.
+				int rc = posix_fallocate(fd,0,(off_t) length);
+				if(rc) {
+					::close(fd);
+					::unlink(filename.c_str());
+					throw system_error(rc,system_category(),filename);
+				}
+			} else {
+				struct stat st;
+				if(fstat(fd,&st)) {
+					int err = errno;
+					::close(fd);
+					throw system_error(err,system_category(),filename);
+				}
+				length = (size_t) st.st_size;
+			}
+
+			if(length < sizeof(Record)) {
+				::close(fd);
+				throw system_error(EINVAL,system_category(),filename);
+			}
+
+			void *ptr = mmap(NULL,length,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+			if(ptr == MAP_FAILED) {
+				int err = errno;
+				::close(fd);
+				throw system_error(err,system_category(),filename);
+			}
+			data = (uint8_t *) ptr;
+
+			// Find the end of the valid records.
+			while(record(used)) {
+				used += record_size(record(used)->length);
+			}
+
+		}
+
+		~Segment() {
+			munmap(data,length);
+			::close(fd);
+		}
+
+		/// @brief Get record, nullptr if there is no valid record at offset.
+		inline Record * record(size_t offset) const noexcept {
+			if(offset + sizeof(Record) > length) {
+				return nullptr;
+			}
+			Record *rec = (Record *) (data + offset);
+			if(__atomic_load_n(&rec->magic,__ATOMIC_ACQUIRE) != magic || rec->length > (length - offset - sizeof(Record))) {
+				return nullptr;
+			}
+			return rec;
+		}
+
+		/// @brief Count undelivered records.
+		size_t undelivered() const noexcept {
+			size_t count = 0;
+			for(size_t offset = 0; offset < used; offset += record_size(record(offset)->length)) {
+				if(!record(offset)->state) {
+					count++;
+				}
+			}
+			return count;
+		}
+
+		/// @brief Write a range of the mapping to disk.
+		void sync(size_t offset, size_t len) const noexcept {
+			static const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+			size_t from = offset & ~(page-1);
+			if(msync(data+from,offset+len-from,MS_SYNC)) {
+				Logger::String{"Cant sync spool segment: ",strerror(errno)}.error("http");
+			}
+		}
+
+		/// @brief Append record, the segment must have room for it.
+		void append(const std::string &payload) noexcept {
+			Record *rec = (Record *) (data + used);
+			memcpy(data+used+sizeof(Record),payload.data(),payload.size());
+			rec->length = (uint32_t) payload.size();
+			rec->state = 0;
+			rec->reserved = 0;
+			sync(used,record_size(payload.size()));
+
+			// The record is on disk, the magic makes it valid.
+			__atomic_store_n(&rec->magic,magic,__ATOMIC_RELEASE);
+			sync(used,sizeof(Record));
+
+			used += record_size(payload.size());
+		}
+
+	};
+
+	HTTP::Spool::Spool(const char *p, const Limits &l, const std::function<bool(const std::string &payload)> &d)
+		: path{p}, limits{l}, deliver{d} {
+
+		// Create directory (and parents).
+		for(size_t pos = path.find('/',1); ; pos = path.find('/',pos+1)) {
+			std::string dir{path,0,pos};
+			if(mkdir(dir.c_str(),0700) && errno != EEXIST) {
+				throw system_error(errno,system_category(),dir);
+			}
+			if(pos == std::string::npos) {
+				break;
+			}
+		}
+
+		// Load segments from the previous run.
+		{
+			DIR *dir = opendir(path.c_str());
+			if(!dir) {
+				throw system_error(errno,system_category(),path);
+			}
+
+			struct dirent *entry;
+			while((entry = readdir(dir)) != NULL) {
+				uint64_t sequence = 0;
+				char suffix[5] = {0};
+				if(sscanf(entry->d_name,"%16" SCNx64 ".%4s",&sequence,suffix) == 2 && sequence && strcmp(suffix,"seg") == 0) {
+					segments.push_back(sequence);
+				}
+			}
+			closedir(dir);
+
+			std::sort(segments.begin(),segments.end());
+		}
+
+		for(auto it = segments.begin(); it != segments.end();) {
+
+			try {
+
+				Segment segment{filename(*it),*it,0};
+				pending += segment.undelivered();
+				bytes += segment.length;
+				it++;
+
+			} catch(const std::exception &e) {
+
+				// Left by a crash (or a full disk), don't let it block the other segments.
+				Logger::String{"Ignoring damaged spool segment: ",e.what()}.warning("http");
+				quarantine(*it);
+				last = std::max(last,*it);
+				it = segments.erase(it);
+
+			}
+
+		}
+
+		if(!segments.empty()) {
+			last = std::max(last,segments.back());
+			writer = make_shared<Segment>(filename(segments.back()),segments.back(),0);
+
+			// Clear leftovers of a torn write.
+			memset(writer->data+writer->used,0,writer->length-writer->used);
+		}
+
+		if(pending) {
+			Logger::String{pending," request(s) on ",path.c_str()," waiting for delivery"}.info("http");
+		}
+
+		worker = std::thread{[this](){
+
+			std::unique_lock<std::mutex> lock{guard};
+			time_t delay = limits.retry;
+
+			std::string payload;
+			uint64_t sequence;
+			size_t offset;
+
+			while(enabled) {
+
+				bool available = false;
+				try {
+
+					available = next(payload,sequence,offset);
+
+				} catch(const std::exception &e) {
+
+					Logger::String{"Error reading ",path.c_str(),": ",e.what()}.error("http");
+
+				}
+
+				if(!available) {
+					cond.wait(lock);
+					continue;
+				}
+
+				lock.unlock();
+
+				bool success = false;
+				try {
+
+					success = deliver(payload);
+
+				} catch(const std::exception &e) {
+
+					Logger::String{e.what()}.error("http");
+
+				}
+
+				lock.lock();
+
+				if(success) {
+					commit(sequence,offset);
+					delay = limits.retry;
+					continue;
+				}
+
+				Logger::String{"Delivery from ",path.c_str()," has failed, retrying in ",(unsigned int) delay," second(s)"}.warning("http");
+				cond.wait_for(lock,std::chrono::seconds(delay),[this](){
+					return !enabled;
+				});
+				delay = std::min(delay * 2, limits.ceiling);
+
+			}
+
+		}};
+
+	}
+
+	HTTP::Spool::~Spool() {
+
+		{
+			std::lock_guard<std::mutex> lock{guard};
+			enabled = false;
+			cond.notify_all();
+		}
+
+		worker.join();
+
+	}
+
+	std::string HTTP::Spool::filename(uint64_t sequence) const {
+		char name[32];
+		snprintf(name,sizeof(name),"/%016" PRIx64 ".seg",sequence);
+		return path + name;
+	}
+
+	void HTTP::Spool::quarantine(uint64_t sequence) noexcept {
+		char name[32];
+		snprintf(name,sizeof(name),"/%016" PRIx64 ".bad",sequence);
+		if(rename(filename(sequence).c_str(),(path + name).c_str())) {
+			unlink(filename(sequence).c_str());
+		}
+	}
+
+	std::shared_ptr<HTTP::Spool::Segment> HTTP::Spool::open(uint64_t sequence) {
+		if(writer && writer->sequence == sequence) {
+			return writer;
+		}
+		return make_shared<Segment>(filename(sequence),sequence,0);
+	}
+
+	void HTTP::Spool::drop() {
+
+		uint64_t sequence = segments.front();
+
+		size_t lost = 0;
+		size_t length = 0;
+		try {
+
+			auto segment = open(sequence);
+			lost = segment->undelivered();
+			length = segment->length;
+
+		} catch(const std::exception &e) {
+
+			Logger::String{e.what()}.error("http");
+
+		}
+
+		if(reader && reader->sequence == sequence) {
+			reader.reset();
+		}
+
+		if(writer && writer->sequence == sequence) {
+			writer.reset();
+		}
+
+		unlink(filename(sequence).c_str());
+		segments.pop_front();
+
+		pending -= std::min(pending,lost);
+		bytes -= std::min(bytes,length);
+		counters.dropped += lost;
+
+		if(lost) {
+			Logger::String{"Spool ",path.c_str()," is full, ",lost," request(s) dropped"}.warning("http");
+		}
+
+	}
+
+	bool HTTP::Spool::empty() noexcept {
+		std::lock_guard<std::mutex> lock{guard};
+		return pending == 0;
+	}
+
+	void HTTP::Spool::push(const std::string &payload) {
+
+		std::lock_guard<std::mutex> lock{guard};
+
+		size_t size = record_size(payload.size());
+
+		if(!writer || writer->used + size > writer->length) {
+
+			size_t length = std::max(limits.segment,size);
+
+			while(!segments.empty() && bytes + length > limits.size) {
+				drop();
+			}
+
+			writer = make_shared<Segment>(filename(last+1),last+1,length);
+			last++;
+			segments.push_back(last);
+			bytes += length;
+
+		}
+
+		writer->append(payload);
+
+		pending++;
+		counters.spooled++;
+
+		cond.notify_all();
+
+	}
+
+	bool HTTP::Spool::next(std::string &payload, uint64_t &sequence, size_t &offset) {
+
+		for(;;) {
+
+			if(!reader) {
+
+				if(segments.empty()) {
+					return false;
+				}
+
+				try {
+
+					reader = open(segments.front());
+
+				} catch(const std::exception &e) {
+
+					Logger::String{"Ignoring damaged spool segment: ",e.what()}.warning("http");
+					quarantine(segments.front());
+					segments.pop_front();
+					continue;
+
+				}
+
+				reader->read = 0;
+			}
+
+			Record *rec = (reader->read < reader->used ? reader->record(reader->read) : nullptr);
+
+			if(!rec) {
+
+				if(reader == writer) {
+					// Nothing left to replay.
+					return false;
+				}
+
+				// All records delivered, remove segment.
+				unlink(filename(reader->sequence).c_str());
+				bytes -= std::min(bytes,reader->length);
+				segments.pop_front();
+				reader.reset();
+				continue;
+
+			}
+
+			if(rec->state) {
+				reader->read += record_size(rec->length);
+				continue;
+			}
+
+			payload.assign((const char *) (rec+1),rec->length);
+			sequence = reader->sequence;
+			offset = reader->read;
+			return true;
+
+		}
+
+	}
+
+	void HTTP::Spool::commit(uint64_t sequence, size_t offset) noexcept {
+
+		if(!reader || reader->sequence != sequence || reader->read != offset) {
+			// Segment dropped while delivering.
+			return;
+		}
+
+		Record *rec = reader->record(offset);
+		if(rec) {
+			rec->state = 1;
+			reader->read += record_size(rec->length);
+		}
+
+		if(pending) {
+			pending--;
+		}
+		counters.replayed++;
+
+	}
+
+#endif // _WIN32
+
+	HTTP::Spool::Metrics HTTP::Spool::metrics() noexcept {
+
+		std::lock_guard<std::mutex> lock{guard};
+
+		Metrics metrics;
+		metrics.pending = pending;
+		metrics.bytes = bytes;
+		metrics.spooled = counters.spooled;
+		metrics.replayed = counters.replayed;
+		metrics.dropped = counters.dropped;
+
+		return metrics;
+
+	}
+
+ }
@@ -0,0 +1,221 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements streaming of JSON responses into values.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <udjat/tools/url/handler/http.h>
+ #include <udjat/tools/http/exception.h>
+ #include <udjat/tools/value.h>
+ #include <udjat/tools/string.h>
+ #include <private/json.h>
+ #include <cstdlib>
+ #include <cstring>
+ #include <system_error>
+ #include <stdexcept>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	namespace {
+
+		/// @brief Build value from the parser events, skipping the elements outside of the filter.
+		class Loader {
+		private:
+			Udjat::Value &root;
+			const std::vector<std::string> &filter;
+
+			/// @brief Open containers, nullptr for the ones outside of the filter.
+			struct Container {
+				Udjat::Value *value;
+				bool array;
+			};
+			std::vector<Container> stack;
+
+			/// @brief Check if the element, or some of its children, are on the filter.
+			bool selected(const std::string &pointer) const noexcept {
+
+				if(filter.empty()) {
+					return true;
+				}
+
+				for(const auto &path : filter) {
+
+					if(path.size() <= pointer.size()) {
+						// Element on the path or inside of it.
+						if(strncmp(pointer.c_str(),path.c_str(),path.size()) == 0 && (pointer.size() == path.size() || pointer[path.size()] == '/')) {
+							return true;
+						}
+					} else if(strncmp(pointer.c_str(),path.c_str(),pointer.size()) == 0 && path[pointer.size()] == '/') {
+						// Element is a parent of the path.
+						return true;
+					}
+
+				}
+
+				return false;
+
+			}
+
+			/// @brief Get the value for the element, nullptr if it is not selected.
+			Udjat::Value * child(const std::string &pointer) {
+
+				if(stack.empty()) {
+					// Top level value.
+					return &root;
+				}
+
+				const Container &parent = stack.back();
+				if(!parent.value || !selected(pointer)) {
+					return nullptr;
+				}
+
+				// Last reference token, unescaped.
+				std::string key;
+				for(size_t ix = pointer.rfind('/')+1; ix < pointer.size(); ix++) {
+					if(pointer[ix] == '~' && ix+1 < pointer.size()) {
+						key += (pointer[++ix] == '1' ? '/' : '~');
+					} else {
+						key += pointer[ix];
+					}
+				}
+
+				if(parent.array) {
+					return &(*parent.value)[atoi(key.c_str())];
+				}
+
+				return &(*parent.value)[key.c_str()];
+
+			}
+
+		public:
+			Loader(Udjat::Value &value, const std::vector<std::string> &f) : root{value}, filter{f} {
+			}
+
+			bool load(HTTP::JsonParser::Event event, const std::string &pointer, const std::string &text) {
+
+				switch(event) {
+				case HTTP::JsonParser::Object:
+				case HTTP::JsonParser::Array:
+					{
+						Udjat::Value *value = child(pointer);
+						if(value && !stack.empty()) {
+							// The top level object is merged into the response.
+							value->set(event == HTTP::JsonParser::Array ? Udjat::Value::Array : Udjat::Value::Object);
+						}
+						stack.push_back(Container{value,event == HTTP::JsonParser::Array});
+					}
+					break;
+
+				case HTTP::JsonParser::End:
+					stack.pop_back();
+					break;
+
+				case HTTP::JsonParser::String:
+					{
+						Udjat::Value *value = child(pointer);
+						if(value) {
+							*value = text;
+						}
+					}
+					break;
+
+				case HTTP::JsonParser::Number:
+					{
+						Udjat::Value *value = child(pointer);
+						if(value) {
+							if(text.find_first_of(".eE") == std::string::npos) {
+								*value = (long long) strtoll(text.c_str(),NULL,10);
+							} else {
+								*value = strtod(text.c_str(),NULL);
+							}
+						}
+					}
+					break;
+
+				case HTTP::JsonParser::Boolean:
+					{
+						Udjat::Value *value = child(pointer);
+						if(value) {
+							*value = (text == "true");
+						}
+					}
+					break;
+
+				case HTTP::JsonParser::Null:
+					child(pointer);
+					break;
+
+				}
+
+				return false;
+
+			}
+
+		};
+
+	}
+
+	bool HTTP::Handler::get(Udjat::Value &value, const HTTP::Method method, const char *payload, const std::vector<std::string> &filter) {
+
+		URL::Handler::set(MimeType::json);
+
+		Loader loader{value,filter};
+		JsonParser parser{[&loader](JsonParser::Event event, const std::string &pointer, const std::string &text){
+			return loader.load(event,pointer,text);
+		}};
+
+		size_t received = 0;
+		std::string error;
+		int rc = perform(method,payload,[&parser,&received,&error](uint64_t, uint64_t, const void *data, size_t length){
+			if(data && length && error.empty()) {
+				received += length;
+				try {
+					parser.parse((const char *) data,length);
+				} catch(const std::exception &e) {
+					// Report after the status, error pages are not always JSON.
+					error = e.what();
+				}
+			}
+			return false;
+		});
+
+		if(rc < 200 || rc > 299) {
+			throw HTTP::Exception((unsigned int) rc, c_str(), status.message.c_str());
+		}
+
+		if(!received) {
+			throw system_error(ENODATA,system_category(),String{"Empty response from ", c_str()});
+		}
+
+		if(!error.empty()) {
+			throw runtime_error(String{"Error parsing response from ",c_str(),": ",error});
+		}
+
+		parser.finish();
+
+		return true;
+
+	}
+
+ }
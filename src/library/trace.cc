@@ -0,0 +1,263 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+
+/*
+ * Copyright (C) 2025 Perry Werneck <perry.werneck@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /**
+  * @brief Implements binary transfer trace.
+  *
+  * Each thread owns a power of two ring of slots; the writer stores the slot
+  * fields and publishes the new head, readers copy a ring and drop the slots
+  * that were overwritten while copying.
+  */
+
+ #include <config.h>
+ #include <udjat/defs.h>
+ #include <private/trace.h>
+ #include <udjat/tools/configuration.h>
+ #include <udjat/tools/logger.h>
+ #include <atomic>
+ #include <chrono>
+ #include <memory>
+ #include <mutex>
+ #include <algorithm>
+ #include <cstdio>
+
+ using namespace std;
+
+ namespace Udjat {
+
+	namespace {
+
+		struct Slot {
+			atomic<uint64_t> time{0};
+			atomic<uint64_t> info{0};		///< @brief Context id (low 32 bits) and type.
+			atomic<uint64_t> size{0};
+		};
+
+		class Ring;
+
+		struct Registry {
+
+			mutex guard;
+			vector<Ring *> rings;
+			uint32_t threads = 0;
+
+			static Registry & instance() {
+				static Registry registry;
+				return registry;
+			}
+
+		};
+
+		class Ring {
+		private:
+			const size_t mask;
+			unique_ptr<Slot[]> slots;
+			atomic<uint64_t> head{0};
+
+			static size_t round(size_t capacity) noexcept {
+				size_t value = 64;
+				while(value < capacity) {
+					value <<= 1;
+				}
+				return value;
+			}
+
+		public:
+			uint32_t thread;
+
+			Ring(size_t capacity) : mask{round(capacity)-1}, slots{new Slot[mask+1]} {
+				Registry &registry = Registry::instance();
+				lock_guard<mutex> lock{registry.guard};
+				thread = ++registry.threads;
+				registry.rings.push_back(this);
+			}
+
+			~Ring() {
+				Registry &registry = Registry::instance();
+				lock_guard<mutex> lock{registry.guard};
+				registry.rings.erase(std::remove(registry.rings.begin(),registry.rings.end(),this),registry.rings.end());
+			}
+
+			inline void push(uint64_t time, uint64_t info, uint64_t size) noexcept {
+				uint64_t pos = head.load(memory_order_relaxed);
+				Slot &slot = slots[pos & mask];
+				slot.time.store(time,memory_order_relaxed);
+				slot.info.store(info,memory_order_relaxed);
+				slot.size.store(size,memory_order_relaxed);
+				head.store(pos+1,memory_order_release);
+			}
+
+			/// @brief Copy the events of a context (0 for all).
+			void copy(vector<HTTP::Trace::Event> &events, uint32_t context) const {
+
+				uint64_t last = head.load(memory_order_acquire);
+				uint64_t first = (last > mask ? last - mask - 1 : 0);
+
+				size_t from = events.size();
+
+				for(uint64_t pos = first; pos < last; pos++) {
+					const Slot &slot = slots[pos & mask];
+					uint64_t info = slot.info.load(memory_order_relaxed);
+					events.push_back(HTTP::Trace::Event{
+						slot.time.load(memory_order_relaxed),
+						(uint32_t) (info & 0xFFFFFFFF),
+						thread,
+						(HTTP::Trace::Type) (info >> 32),
+						slot.size.load(memory_order_relaxed)
+					});
+				}
+
+				// The slots reused by the writer while copying are not valid.
+				atomic_thread_fence(memory_order_acquire);
+				uint64_t now = head.load(memory_order_relaxed);
+				size_t overwritten = 0;
+				if(now > mask) {
+					uint64_t valid = now - mask;
+					if(valid > first) {
+						overwritten = (size_t) std::min(valid - first, last - first);
+					}
+				}
+
+				auto begin = events.begin() + from;
+				events.erase(begin,begin+overwritten);
+
+				if(context) {
+					events.erase(
+						std::remove_if(events.begin()+from,events.end(),[context](const HTTP::Trace::Event &event){
+							return event.context != context;
+						}),
+						events.end()
+					);
+				}
+
+			}
+
+		};
+
+		static const char * names[] = {
+			"text",
+			"header-in",
+			"header-out",
+			"data-in",
+			"data-out",
+			"ssl-data-in",
+			"ssl-data-out",
+		};
+
+	}
+
+	uint32_t HTTP::Trace::id() noexcept {
+		static atomic<uint32_t> last{0};
+		uint32_t value = ++last;
+		if(!value) {
+			value = ++last;		// 0 means all contexts.
+		}
+		return value;
+	}
+
+	void HTTP::Trace::record(uint32_t context, Type type, size_t size) noexcept {
+
+		static const size_t capacity = Config::Value<unsigned int>("http","trace-events",4096).get();
+
+		try {
+
+			thread_local Ring ring{capacity};
+
+			ring.push(
+				(uint64_t) chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count(),
+				((uint64_t) type << 32) | context,
+				size
+			);
+
+		} catch(...) {
+
+			// No memory for the ring, the event is lost.
+
+		}
+
+	}
+
+	std::vector<HTTP::Trace::Event> HTTP::Trace::events(uint32_t context) {
+
+		vector<Event> events;
+
+		{
+			Registry &registry = Registry::instance();
+			lock_guard<mutex> lock{registry.guard};
+			for(const Ring *ring : registry.rings) {
+				ring->copy(events,context);
+			}
+		}
+
+		std::stable_sort(events.begin(),events.end(),[](const Event &a, const Event &b){
+			return a.time < b.time;
+		});
+
+		return events;
+
+	}
+
+	/// @brief Format event as 'seconds.microseconds thread context type size'.
+	static void format(char *buffer, size_t length, const HTTP::Trace::Event &event) {
+		snprintf(
+			buffer,length,
+			"%llu.%06llu thread=%u context=%u %s %llu bytes",
+			(unsigned long long) (event.time / 1000000000ULL),
+			(unsigned long long) ((event.time % 1000000000ULL) / 1000ULL),
+			event.thread,
+			event.context,
+			(event.type < (sizeof(names)/sizeof(names[0])) ? names[event.type] : "unknown"),
+			(unsigned long long) event.size
+		);
+	}
+
+	std::string HTTP::Trace::dump(uint32_t context) {
+
+		std::string text;
+		char line[128];
+
+		for(const auto &event : events(context)) {
+			format(line,sizeof(line),event);
+			text += line;
+			text += '\n';
+		}
+
+		return text;
+
+	}
+
+	void HTTP::Trace::write(uint32_t context) noexcept {
+
+		try {
+
+			char line[128];
+			for(const auto &event : events(context)) {
+				format(line,sizeof(line),event);
+				Logger::String{line}.write(Logger::Debug,"curl");
+			}
+
+		} catch(...) {
+
+			// Tracing must not fail the transfer.
+
+		}
+
+	}
+
+ }